@@ -16,125 +16,701 @@
 
 #include "fifo.h"
 
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <time.h>
+
+#define FIFO_CACHE_LINE (FIFO_ALIGNMENT)
+#define FIFO_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define FIFO_WAIT_SPINS (256)       /* Checks of the other side's index before sleeping */
 
 /**
  * \brief   Struct to describe fifo object
- * \details Contains read and write index, and the buffer
+ * \details Contains read and write index, and the settings of the fifo; its items follow, FIFO_HEADER_SIZE
+ *          bytes after its start.
+ *          The indices run freely and are masked to address the buffer, so that all the items are used.
+ *          Each index is on the cache line of the side which writes it, with that side's copy of the
+ *          other index: the other index is only loaded again when the copy says the fifo is full
+ *          (producer) or empty (consumer), so the two sides don't steal each other's cache line.
+ *          The write index is published with release semantics after the item is written, and the
+ *          read index after the item is read; each side loads the other's index with acquire semantics.
+ *          With FIFO_OVERWRITE_OLDEST, the producer moves the read index past the oldest items when the
+ *          fifo is full, so the consumer moves it with a compare and swap, and checks that it didn't move
+ *          while it was copying an item. The consumer counts the items overwritten from the jumps of the
+ *          read index, as only it knows whether it holds the item the producer dropped.
+ *          A consumer going to sleep sets waiting, then checks the write index again; a producer loads
+ *          waiting after publishing the write index, with a full fence between the two on both sides, so
+ *          that either the consumer sees the new item or the producer sees it waiting and wakes it up.
+ *          The consumer sleeps on the write index (futex) or in epoll on notify_fd (eventfd).
+ *          With FIFO_BLOCK, a producer finding the fifo full sleeps on the read index (futex) the same
+ *          way: it sets producer_waiting, then checks the read index again, and the consumer loads
+ *          producer_waiting after publishing the read index.
  */
 struct hsi_fifo_s
 {
-    volatile uint32_t read_index;       /*!< read index */
-    volatile uint32_t write_index;      /*!< write index */
-    volatile uint32_t rejected_count;   /*!< count the number of rejected values in push (if fifo is full for example) */
-    fifo_item_t buff[FIFO_MAX_ITEMS];   /*!< buffer for the fifo */
+    /* Producer side */
+    _Alignas(FIFO_CACHE_LINE) atomic_uint_least32_t write_index;   /*!< write index */
+    uint32_t read_index_cache;                                      /*!< read index, as last loaded by the producer */
+
+    /* Consumer side */
+    _Alignas(FIFO_CACHE_LINE) atomic_uint_least32_t read_index;    /*!< read index */
+    uint32_t write_index_cache;                                     /*!< write index, as last loaded by the consumer */
+    uint32_t read_position;                                         /*!< read index, as last seen by the consumer (FIFO_OVERWRITE_OLDEST) */
+    uint32_t holding;                                               /*!< 1 if the consumer read the item at read_position (FIFO_OVERWRITE_OLDEST) */
+    uint32_t overwritten_count;                                     /*!< items overwritten, not reported yet (FIFO_OVERWRITE_OLDEST) */
+
+    _Alignas(FIFO_CACHE_LINE) atomic_uint_least32_t rejected_count; /*!< count the number of rejected values in push (if fifo is full for example) */
+    uint32_t lost_count;                                            /*!< count of the last FIFO_LOST, written by the consumer */
+    atomic_uint_least64_t lost_total;                               /*!< items lost since the creation, written by the producer (the consumer with FIFO_OVERWRITE_OLDEST) */
+    uint32_t policy;                                                /*!< overflow policy (FIFO_REJECT_NEWEST, ...) */
+    uint32_t item_size;                                             /*!< size of an item */
+    uint32_t item_stride;                                           /*!< bytes between two items */
+    uint32_t capacity;                                              /*!< number of items, a power of two */
+    size_t mapped_size;                                             /*!< size of the memory mapped by fifo_create_huge, 0 otherwise */
+    atomic_uint_least32_t waiting;                                  /*!< whether the consumer is asleep, or going to sleep */
+    atomic_uint_least32_t producer_waiting;                         /*!< whether the producer is asleep on a full fifo (FIFO_BLOCK) */
+    int notify_fd;                                                  /*!< eventfd written when the consumer is asleep, -1 if none */
 };
 
-static hsi_fifo_t fifo;
+_Static_assert(sizeof(struct hsi_fifo_s) <= FIFO_HEADER_SIZE, "FIFO_HEADER_SIZE too small");
+_Static_assert((FIFO_MAX_ITEMS & (FIFO_MAX_ITEMS - 1)) == 0, "FIFO_MAX_ITEMS must be a power of two");
+
+/* Memory of the fifos of fifo_item_t */
+static _Alignas(FIFO_ALIGNMENT) uint8_t instances[FIFO_INSTANCES][FIFO_MEMORY_SIZE(sizeof(fifo_item_t), FIFO_MAX_ITEMS)];
 
 /**
- * \brief       Thread safe setting a uint32_t to a value
- * \details     do *src = var2, using only atomic functions
- *              Warning : We must to be sure that *src is not set during execution of this function
- * \param      	src     : pointer to variable to set
- * \param       value   : value to set
- * \return   	int32_t : 0 if everything is OK -errno otherwise
+ * \brief       Get the address of an item
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       index   : Index of the item, not masked
+ * \return      uint8_t* : address of the item
  */
-static void set_atomic(volatile uint32_t* src, uint32_t value)
+static inline uint8_t* item_at(hsi_fifo_t* p_fifo, uint32_t index)
+{
+    return (uint8_t*)p_fifo + FIFO_HEADER_SIZE + (size_t)(index & (p_fifo->capacity - 1)) * p_fifo->item_stride;
+}
+
+hsi_fifo_t* fifo_create(void* memory, size_t size, uint32_t item_size, uint32_t capacity, uint32_t policy)
 {
-    uint32_t src_value = *src;
-    uint32_t delta = 0;
+    hsi_fifo_t* p_fifo = NULL;
 
-    if (value == 0)
+    if (memory != NULL && (uintptr_t)memory % FIFO_ALIGNMENT == 0 && item_size > 0 && policy <= FIFO_BLOCK &&
+        capacity > 0 && (capacity & (capacity - 1)) == 0 && capacity <= UINT32_MAX / 2 &&
+        size >= FIFO_MEMORY_SIZE(item_size, capacity))
     {
-        (*src) &= 0x00000000;
+        p_fifo = memory;
+        atomic_init(&p_fifo->write_index, 0);
+        atomic_init(&p_fifo->read_index, 0);
+        atomic_init(&p_fifo->rejected_count, 0);
+        atomic_init(&p_fifo->lost_total, 0);
+        p_fifo->read_index_cache = 0;
+        p_fifo->write_index_cache = 0;
+        p_fifo->read_position = 0;
+        p_fifo->holding = 0;
+        p_fifo->overwritten_count = 0;
+        p_fifo->lost_count = 0;
+        p_fifo->policy = policy;
+        p_fifo->item_size = item_size;
+        p_fifo->item_stride = (uint32_t)FIFO_ITEM_STRIDE(item_size);
+        p_fifo->capacity = capacity;
+        p_fifo->mapped_size = 0;
+        atomic_init(&p_fifo->waiting, 0);
+        atomic_init(&p_fifo->producer_waiting, 0);
+        p_fifo->notify_fd = -1;
     }
-    else if (src_value < value)
+
+    return p_fifo;
+}
+
+hsi_fifo_t* fifo_create_huge(uint32_t item_size, uint32_t capacity, uint32_t policy)
+{
+    hsi_fifo_t* p_fifo = NULL;
+    size_t size = (FIFO_MEMORY_SIZE(item_size, capacity) + FIFO_HUGE_PAGE_SIZE - 1) & ~(size_t)(FIFO_HUGE_PAGE_SIZE - 1);
+
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory == MAP_FAILED)   /* no huge page reserved: transparent huge pages */
     {
-        delta = value - src_value;
-        (*src) += delta;
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory != MAP_FAILED) {
+            madvise(memory, size, MADV_HUGEPAGE);
+        }
     }
-    else if (src_value > value) {
-        delta = src_value - value;
-        (*src) -= delta;
+
+    if (memory != MAP_FAILED)
+    {
+        p_fifo = fifo_create(memory, size, item_size, capacity, policy);
+        if (p_fifo == NULL) {
+            munmap(memory, size);
+            errno = EINVAL;
+        }
+        else {
+            p_fifo->mapped_size = size;
+        }
     }
+
+    return p_fifo;
 }
 
-hsi_fifo_t* fifo_init(void)
+void fifo_destroy(hsi_fifo_t* p_fifo)
 {
-    fifo.write_index = 0;
-    fifo.read_index = 0;
-    fifo.rejected_count = 0;
-    memset(&fifo.buff, 0, sizeof(fifo.buff));
+    if (p_fifo != NULL && p_fifo->notify_fd != -1) {
+        close(p_fifo->notify_fd);
+        p_fifo->notify_fd = -1;
+    }
+    if (p_fifo != NULL && p_fifo->mapped_size != 0) {
+        munmap(p_fifo, p_fifo->mapped_size);
+    }
+}
 
-    return &fifo;
+hsi_fifo_t* fifo_init(void)
+{
+    return fifo_init_instance(0);
 }
 
 hsi_fifo_t* fifo_get_pointer(void)
 {
-    return &fifo;
+    return fifo_get_instance_pointer(0);
 }
 
-int32_t fifo_push(hsi_fifo_t* p_fifo, const fifo_item_t* item)
+hsi_fifo_t* fifo_init_instance(uint32_t id)
+{
+    hsi_fifo_t* p_fifo = NULL;
+
+    if (id < FIFO_INSTANCES) {
+        p_fifo = fifo_create(instances[id], sizeof(instances[id]), sizeof(fifo_item_t), FIFO_MAX_ITEMS, FIFO_BLOCK);
+    }
+
+    return p_fifo;
+}
+
+hsi_fifo_t* fifo_get_instance_pointer(uint32_t id)
+{
+    hsi_fifo_t* p_fifo = NULL;
+
+    if (id < FIFO_INSTANCES) {
+        p_fifo = (hsi_fifo_t*)instances[id];
+    }
+
+    return p_fifo;
+}
+
+/**
+ * \brief       Let the other thread run on the core while spinning
+ */
+static inline void spin_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * \brief       Wake the consumer up if it is asleep (producer)
+ * \details     Called after the write index is published. Only a fence and a load if the consumer is awake.
+ * \param       p_fifo  : Pointer to the fifo object
+ */
+static void notify(hsi_fifo_t* p_fifo)
+{
+    atomic_thread_fence(memory_order_seq_cst);  /* write index published before waiting is loaded */
+    if (atomic_load_explicit(&p_fifo->waiting, memory_order_relaxed))
+    {
+        syscall(SYS_futex, &p_fifo->write_index, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        if (p_fifo->notify_fd != -1) {
+            eventfd_write(p_fifo->notify_fd, 1);
+        }
+    }
+}
+
+/**
+ * \brief       Add items lost to the total
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       count   : Number of items lost
+ */
+static void add_lost_total(hsi_fifo_t* p_fifo, uint32_t count)
+{
+    atomic_store_explicit(&p_fifo->lost_total,
+                          atomic_load_explicit(&p_fifo->lost_total, memory_order_relaxed) + count,
+                          memory_order_relaxed);    /* single writer */
+}
+
+/**
+ * \brief       Count items lost by the producer
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       count   : Number of items lost
+ */
+static void count_lost(hsi_fifo_t* p_fifo, uint32_t count)
+{
+    atomic_fetch_add_explicit(&p_fifo->rejected_count, count, memory_order_relaxed);
+    add_lost_total(p_fifo, count);
+}
+
+/**
+ * \brief       Check whether there is room for items to write, as last seen by the producer
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       write_index : Write index of the producer
+ * \param       count       : Number of items to write
+ * \return      int : 1 if there is room, 0 otherwise
+ */
+static inline int has_room(const hsi_fifo_t* p_fifo, uint32_t write_index, uint32_t count)
+{
+    return p_fifo->capacity - (write_index - p_fifo->read_index_cache) >= count;
+}
+
+/**
+ * \brief       Wait until the consumer releases items of a full fifo (producer, FIFO_BLOCK)
+ * \details     Spins shortly, then sleeps on a futex on the read index until the consumer releases items.
+ *              Reloads the read index.
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       write_index : Write index of the producer
+ * \param       count       : Number of items to write
+ */
+static void wait_room(hsi_fifo_t* p_fifo, uint32_t write_index, uint32_t count)
+{
+    /* Items released soon are taken without the latency of a wake up */
+    for (uint32_t i = 0; i < FIFO_WAIT_SPINS && !has_room(p_fifo, write_index, count); i++)
+    {
+        spin_pause();
+        p_fifo->read_index_cache = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+    }
+
+    if (!has_room(p_fifo, write_index, count))
+    {
+        atomic_store_explicit(&p_fifo->producer_waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);  /* producer_waiting set before the read index is loaded */
+        p_fifo->read_index_cache = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+        if (!has_room(p_fifo, write_index, count)) {
+            /* The kernel doesn't sleep if the read index was published meanwhile */
+            syscall(SYS_futex, &p_fifo->read_index, FUTEX_WAIT_PRIVATE, p_fifo->read_index_cache, NULL, NULL, 0);
+        }
+        atomic_store_explicit(&p_fifo->producer_waiting, 0, memory_order_relaxed);
+        p_fifo->read_index_cache = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+    }
+}
+
+/**
+ * \brief       Make room for items to write, following the overflow policy of the fifo (producer)
+ * \details     Loads the read index again only if the fifo is full as last seen
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       write_index : Write index of the producer
+ * \param       count       : Number of items to write
+ * \return      int32_t : FIFO_DATA if there is room for the items
+ *                        FIFO_OVERRUN (fifo full, the items are rejected and counted as lost)
+ */
+static int32_t make_room(hsi_fifo_t* p_fifo, uint32_t write_index, uint32_t count)
+{
+    int32_t ret = FIFO_DATA;
+
+    if (!has_room(p_fifo, write_index, count)) {   /* full as last seen */
+        p_fifo->read_index_cache = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+    }
+    while (ret == FIFO_DATA && !has_room(p_fifo, write_index, count))
+    {
+        uint32_t missing = count - (p_fifo->capacity - (write_index - p_fifo->read_index_cache));
+
+        switch (p_fifo->policy)
+        {
+        case FIFO_OVERWRITE_OLDEST:
+            /* Drop the oldest items, unless the consumer released them meanwhile (the cache is reloaded).
+               The consumer counts them, as it may have read the first one already. */
+            if (atomic_compare_exchange_weak_explicit(&p_fifo->read_index, &p_fifo->read_index_cache,
+                                                      p_fifo->read_index_cache + missing,
+                                                      memory_order_acq_rel, memory_order_acquire))
+            {
+                p_fifo->read_index_cache += missing;
+            }
+            break;
+
+        case FIFO_BLOCK:
+            wait_room(p_fifo, write_index, count);
+            break;
+
+        default:    /* FIFO_REJECT_NEWEST */
+            count_lost(p_fifo, count);
+            ret = FIFO_OVERRUN;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+int32_t fifo_push_data(hsi_fifo_t* p_fifo, const void* data)
 {
     int32_t ret = FIFO_DATA;
-    uint32_t new_write_index = (p_fifo->write_index + 1) % FIFO_MAX_ITEMS;
 
-    if (p_fifo == NULL || item == NULL) {
+    if (p_fifo == NULL || data == NULL) {
         ret = FIFO_FAILURE;
     }
-    else if (new_write_index == p_fifo->read_index) {
-        ret = FIFO_OVERRUN;
+    else
+    {
+        uint32_t write_index = atomic_load_explicit(&p_fifo->write_index, memory_order_relaxed);
+
+        ret = make_room(p_fifo, write_index, 1);
+        if (ret == FIFO_DATA) {
+            memcpy(item_at(p_fifo, write_index), data, p_fifo->item_size);
+            atomic_store_explicit(&p_fifo->write_index, write_index + 1, memory_order_release);
+            notify(p_fifo);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * \brief       Release items to the producer (consumer)
+ * \details     The items are read before their slots are released. With FIFO_OVERWRITE_OLDEST, the items
+ *              are left as dropped if the producer already moved the read index past them.
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       read_index  : Read index of the consumer
+ * \param       count       : Number of items
+ */
+static void release(hsi_fifo_t* p_fifo, uint32_t read_index, uint32_t count)
+{
+    if (p_fifo->policy == FIFO_OVERWRITE_OLDEST) {
+        atomic_compare_exchange_strong_explicit(&p_fifo->read_index, &read_index, read_index + count,
+                                                memory_order_acq_rel, memory_order_relaxed);
     }
     else {
-        memcpy(&p_fifo->buff[p_fifo->write_index], item, sizeof(*item));
-        set_atomic(&p_fifo->write_index, new_write_index);
+        atomic_store_explicit(&p_fifo->read_index, read_index + count, memory_order_release);
+        if (p_fifo->policy == FIFO_BLOCK)
+        {
+            /* Wake the producer up if it is asleep on the full fifo */
+            atomic_thread_fence(memory_order_seq_cst);  /* read index published before producer_waiting is loaded */
+            if (atomic_load_explicit(&p_fifo->producer_waiting, memory_order_relaxed)) {
+                syscall(SYS_futex, &p_fifo->read_index, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+            }
+        }
+    }
+}
+
+/**
+ * \brief       Check whether the consumer has an item to read
+ * \details     Loads the write index again only if the fifo is empty as last seen
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       read_index  : Read index of the consumer
+ * \return      int : 1 if the fifo is empty, 0 otherwise
+ */
+static int is_empty(hsi_fifo_t* p_fifo, uint32_t read_index)
+{
+    /* With FIFO_OVERWRITE_OLDEST, the producer may have moved the read index past the copy */
+    if ((int32_t)(p_fifo->write_index_cache - read_index) <= 0) {
+        p_fifo->write_index_cache = atomic_load_explicit(&p_fifo->write_index, memory_order_acquire);
+    }
+    return read_index == p_fifo->write_index_cache;
+}
+
+/**
+ * \brief       Count the items the producer overwrote since the consumer last saw the read index (consumer)
+ * \details     With FIFO_OVERWRITE_OLDEST. The item the consumer holds at its read position isn't lost.
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       read_index  : Read index, as loaded
+ */
+static void count_overwritten(hsi_fifo_t* p_fifo, uint32_t read_index)
+{
+    if (read_index != p_fifo->read_position)
+    {
+        uint32_t count = read_index - p_fifo->read_position - p_fifo->holding;
+
+        p_fifo->overwritten_count += count;
+        add_lost_total(p_fifo, count);
+        p_fifo->read_position = read_index;
+        p_fifo->holding = 0;
+    }
+}
+
+/**
+ * \brief       Take the count of the items lost since the last call (consumer)
+ * \param       p_fifo  : Pointer to the fifo object
+ * \return      int : 1 if items were lost, their count is in lost_count, 0 otherwise
+ */
+static int take_lost(hsi_fifo_t* p_fifo)
+{
+    uint32_t lost = p_fifo->overwritten_count;
+
+    if (atomic_load_explicit(&p_fifo->rejected_count, memory_order_relaxed) > 0) {
+        lost += atomic_exchange_explicit(&p_fifo->rejected_count, 0, memory_order_relaxed);
+    }
+    p_fifo->overwritten_count = 0;
+    if (lost > 0) {
+        p_fifo->lost_count = lost;
     }
+    return lost > 0;
+}
+
+int32_t fifo_read_data(hsi_fifo_t* p_fifo, void* data)
+{
+    int32_t ret = FIFO_EMPTY;
 
+    if (p_fifo == NULL || data == NULL) {
+        ret = FIFO_FAILURE;
+    }
+    else
+    {
+        uint32_t read_index = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+        int retry;
+
+        do
+        {
+            retry = 0;
+            if (p_fifo->policy == FIFO_OVERWRITE_OLDEST) {
+                count_overwritten(p_fifo, read_index);
+            }
+
+            if (take_lost(p_fifo)) {        /* reported before the items pushed after them */
+                ret = FIFO_LOST;
+            }
+            else if (!is_empty(p_fifo, read_index))     /* read = write -> empty fifo */
+            {
+                memcpy(data, item_at(p_fifo, read_index), p_fifo->item_size);
+                ret = FIFO_DATA;
+
+                if (p_fifo->policy == FIFO_OVERWRITE_OLDEST)
+                {
+                    /* The item may have been overwritten during the copy: it is lost, unless it was held */
+                    atomic_thread_fence(memory_order_acquire);
+                    uint32_t current = atomic_load_explicit(&p_fifo->read_index, memory_order_relaxed);
+                    if (current != read_index)
+                    {
+                        read_index = current;
+                        ret = FIFO_EMPTY;
+                        retry = 1;
+                    }
+                    else {
+                        p_fifo->holding = 1;
+                    }
+                }
+            }
+        } while (retry);
+    }
     return ret;
 }
 
-int32_t fifo_read(hsi_fifo_t* p_fifo, fifo_item_t* item)
+int32_t fifo_next_data(hsi_fifo_t* p_fifo, void* data)
 {
     int32_t ret = 0;
 
-    if (p_fifo == NULL || item == NULL) {
+    if (p_fifo == NULL ) {
         ret = FIFO_FAILURE;
     }
-    else if (p_fifo->rejected_count > 0)
+    else
     {
-        p_fifo->rejected_count &= 0x00000000;
-        ret = FIFO_LOST;
+        uint32_t read_index = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+
+        if (is_empty(p_fifo, read_index))       /* read = write -> empty fifo */
+        {
+            ret = FIFO_EMPTY;
+        }
+        else if (p_fifo->policy == FIFO_OVERWRITE_OLDEST)
+        {
+            /* The item at the read position is released, unless the producer dropped it meanwhile: either
+               way, it isn't lost */
+            read_index = p_fifo->read_position;
+            if (atomic_compare_exchange_strong_explicit(&p_fifo->read_index, &read_index, read_index + 1,
+                                                        memory_order_acq_rel, memory_order_acquire))
+            {
+                p_fifo->read_position = read_index + 1;
+                p_fifo->holding = 0;
+            }
+            else
+            {
+                p_fifo->holding = 1;
+                count_overwritten(p_fifo, read_index);
+            }
+            ret = fifo_read_data(p_fifo, data);
+        }
+        else {
+            release(p_fifo, read_index, 1);
+            ret = fifo_read_data(p_fifo, data);
+        }
+    }
+    return ret;
+}
+
+/**
+ * \brief       Describe items of the ring
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       index   : Index of the first item, not masked
+ * \param       count   : Number of items
+ * \param[out]  span    : Items
+ */
+static void set_span(hsi_fifo_t* p_fifo, uint32_t index, uint32_t count, fifo_span_t* span)
+{
+    uint32_t until_end = p_fifo->capacity - (index & (p_fifo->capacity - 1));
+
+    span->first = item_at(p_fifo, index);
+    span->first_count = count < until_end ? count : until_end;
+    span->second = item_at(p_fifo, 0);
+    span->second_count = count - span->first_count;
+    span->item_stride = p_fifo->item_stride;
+}
+
+int32_t fifo_reserve(hsi_fifo_t* p_fifo, uint32_t count, fifo_span_t* span)
+{
+    int32_t ret = FIFO_DATA;
+
+    if (p_fifo == NULL || span == NULL || count > p_fifo->capacity) {
+        ret = FIFO_FAILURE;
+    }
+    else
+    {
+        uint32_t write_index = atomic_load_explicit(&p_fifo->write_index, memory_order_relaxed);
+
+        ret = make_room(p_fifo, write_index, count);
+        if (ret == FIFO_DATA) {
+            set_span(p_fifo, write_index, count, span);
+        }
+    }
+
+    return ret;
+}
+
+void fifo_commit(hsi_fifo_t* p_fifo, uint32_t count)
+{
+    uint32_t write_index = atomic_load_explicit(&p_fifo->write_index, memory_order_relaxed);
+
+    /* The items are written before they are published */
+    atomic_store_explicit(&p_fifo->write_index, write_index + count, memory_order_release);
+    notify(p_fifo);
+}
+
+int32_t fifo_peek(hsi_fifo_t* p_fifo, uint32_t max_count, fifo_span_t* span)
+{
+    int32_t ret = FIFO_DATA;
+
+    if (p_fifo == NULL || span == NULL || max_count == 0 || p_fifo->policy == FIFO_OVERWRITE_OLDEST) {
+        ret = FIFO_FAILURE;
     }
-    else if (p_fifo->read_index == p_fifo->write_index) {  /* read = write -> empty fifo */
-        ret = FIFO_EMPTY;
+    else if (take_lost(p_fifo)) {
+        ret = FIFO_LOST;
     }
     else
     {
-        memcpy(item, &p_fifo->buff[p_fifo->read_index], sizeof(*item));
-        ret = FIFO_DATA;
+        uint32_t read_index = atomic_load_explicit(&p_fifo->read_index, memory_order_relaxed);
+
+        if (is_empty(p_fifo, read_index)) {     /* read = write -> empty fifo */
+            ret = FIFO_EMPTY;
+        }
+        else
+        {
+            uint32_t count = p_fifo->write_index_cache - read_index;
+            set_span(p_fifo, read_index, count < max_count ? count : max_count, span);
+        }
+    }
+    return ret;
+}
+
+void fifo_release(hsi_fifo_t* p_fifo, uint32_t count)
+{
+    release(p_fifo, atomic_load_explicit(&p_fifo->read_index, memory_order_acquire), count);
+}
+
+uint32_t fifo_lost_count(const hsi_fifo_t* p_fifo)
+{
+    return p_fifo->lost_count;
+}
+
+uint64_t fifo_lost_total(const hsi_fifo_t* p_fifo)
+{
+    return atomic_load_explicit(&p_fifo->lost_total, memory_order_relaxed);
+}
+
+int32_t fifo_push(hsi_fifo_t* p_fifo, const fifo_item_t* item)
+{
+    return fifo_push_data(p_fifo, item);
+}
+
+int32_t fifo_read(hsi_fifo_t* p_fifo, fifo_item_t* item)
+{
+    int32_t ret = fifo_read_data(p_fifo, item);
+
+    if (ret == FIFO_LOST) {
+        item->lns_frame_count = p_fifo->lost_count;
     }
     return ret;
 }
 
 int32_t fifo_next(hsi_fifo_t* p_fifo, fifo_item_t* item)
 {
-    int32_t ret = 0;
+    int32_t ret = fifo_next_data(p_fifo, item);
 
-    if (p_fifo == NULL ) {
+    if (ret == FIFO_LOST) {
+        item->lns_frame_count = p_fifo->lost_count;
+    }
+    return ret;
+}
+
+int fifo_notify_fd(hsi_fifo_t* p_fifo)
+{
+    if (p_fifo != NULL && p_fifo->notify_fd == -1) {
+        p_fifo->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    return p_fifo != NULL ? p_fifo->notify_fd : -1;
+}
+
+int32_t fifo_prepare_wait(hsi_fifo_t* p_fifo)
+{
+    int32_t ret = FIFO_EMPTY;
+
+    if (p_fifo == NULL) {
         ret = FIFO_FAILURE;
     }
-    else if (p_fifo->read_index == p_fifo->write_index) /* read = write -> empty fifo */
+    else
     {
-        ret = FIFO_EMPTY;
+        atomic_store_explicit(&p_fifo->waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);  /* waiting set before the write index is loaded */
+        if (!is_empty(p_fifo, atomic_load_explicit(&p_fifo->read_index, memory_order_acquire)) ||
+            atomic_load_explicit(&p_fifo->rejected_count, memory_order_relaxed) > 0 || p_fifo->overwritten_count > 0)
+        {
+            atomic_store_explicit(&p_fifo->waiting, 0, memory_order_relaxed);
+            ret = FIFO_DATA;
+        }
     }
-    else {
-        set_atomic(&p_fifo->read_index, (p_fifo->read_index + 1) % FIFO_MAX_ITEMS);
-        ret = fifo_read(p_fifo, item);
+    return ret;
+}
+
+void fifo_finish_wait(hsi_fifo_t* p_fifo)
+{
+    eventfd_t count;
+
+    atomic_store_explicit(&p_fifo->waiting, 0, memory_order_relaxed);
+    if (p_fifo->notify_fd != -1) {
+        eventfd_read(p_fifo->notify_fd, &count);
+    }
+}
+
+int32_t fifo_wait(hsi_fifo_t* p_fifo, int32_t timeout_ms)
+{
+    int32_t ret = FIFO_FAILURE;
+
+    if (p_fifo != NULL)
+    {
+        uint32_t read_index = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+
+        /* Items coming soon are taken without the latency of a wake up */
+        for (uint32_t i = 0; i < FIFO_WAIT_SPINS && is_empty(p_fifo, read_index); i++) {
+            spin_pause();
+        }
+
+        ret = fifo_prepare_wait(p_fifo);
+        if (ret == FIFO_EMPTY)
+        {
+            struct timespec timeout = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+
+            /* The write index is the futex word: the kernel doesn't sleep if it was published meanwhile */
+            syscall(SYS_futex, &p_fifo->write_index, FUTEX_WAIT_PRIVATE, p_fifo->write_index_cache,
+                    timeout_ms < 0 ? NULL : &timeout, NULL, 0);
+            fifo_finish_wait(p_fifo);
+            read_index = atomic_load_explicit(&p_fifo->read_index, memory_order_acquire);
+            ret = is_empty(p_fifo, read_index) ? FIFO_EMPTY : FIFO_DATA;
+        }
     }
     return ret;
 }
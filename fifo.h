@@ -12,30 +12,119 @@
  *                  push : insert in the buffer
  *                  read : get fist data from the buffer
  *                  next : go to the next value, and read the new value
+ *
+ *              Any number of fifos can be created, each with its own item size and power of two capacity,
+ *              in memory given by the caller (fifo_create) or in huge pages (fifo_create_huge).
+ *              FIFO_DECLARE_TYPED declares type safe functions for a fifo of a given item type.
+ *
+ *              Each fifo has an overflow policy: a full fifo rejects the newest item, overwrites the oldest
+ *              one or blocks the producer. The items rejected or overwritten are counted: the consumer gets
+ *              FIFO_LOST with their exact count before the next item.
+ *
+ *              Instead of spinning on an empty fifo, the consumer can sleep: on a futex (fifo_wait), or in
+ *              epoll on the eventfd of the fifo (fifo_notify_fd, fifo_prepare_wait, fifo_finish_wait). The
+ *              producer only makes a system call to wake the consumer up when it is asleep.
+ *
+ *              Without copy, the producer reserves items in the ring (fifo_reserve), writes them and
+ *              publishes them at once (fifo_commit), and the consumer gets the items in the ring (fifo_peek)
+ *              and releases them at once (fifo_release), with a single index update per batch.
+ *              The FIFO_INSTANCES fifos of fifo_item_t are kept for the outputs of the threaded loop, and
+ *              block. Its inputs go through a udp_frame and a lns_batch typed fifo.
  */
 
 #ifndef FIFO_H_
 #define FIFO_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "lib/drv_api.h"
+
 /* TODO : Can be adjusted depending on push/read frequency */
-#define FIFO_MAX_ITEMS  (256)           /* Max number of elements in fifo */
+#define FIFO_MAX_ITEMS  (256)           /* Max number of elements in fifo, a power of two */
+#define FIFO_INSTANCES  (2)             /* Number of fifos: one per direction between two threads */
+
+/* Memory of a fifo */
+#define FIFO_ALIGNMENT  (64)            /* Alignment of the memory of a fifo, a cache line */
+#define FIFO_HEADER_SIZE (256)          /* Indices and settings, before the items */
+#define FIFO_ITEM_STRIDE(item_size) \
+    (((size_t)(item_size) + 7) & ~(size_t)7)                    /* Bytes between two items */
+#define FIFO_MEMORY_SIZE(item_size, capacity) \
+    (FIFO_HEADER_SIZE + FIFO_ITEM_STRIDE(item_size) * (size_t)(capacity))   /* Bytes of a fifo */
 
 /* Return codes */
 #define FIFO_FAILURE    (-1)            /* Bad parameters, NULL pointers or excluded ID */
 #define FIFO_DATA       (0)             /* "Normal" data item is returned or stored */
 #define FIFO_EMPTY      (1)             /* (read) FIFO is empty, no data returned */
 #define FIFO_OVERRUN    (2)             /* (push) FIFO is full, data item is rejected */
-#define FIFO_LOST       (3)             /* (read) 'sz_or_count' set to the count of lost items */
+#define FIFO_LOST       (3)             /* (read) count of lost items in fifo_lost_count(), and in lns_frame_count for fifo_item_t */
+
+/* Overflow policies, when an item is pushed into a full fifo */
+#define FIFO_REJECT_NEWEST      (0)     /* The item pushed is rejected (FIFO_OVERRUN) */
+#define FIFO_OVERWRITE_OLDEST   (1)     /* The oldest item is dropped, for telemetry and latest value signals */
+#define FIFO_BLOCK              (2)     /* The producer sleeps until the consumer releases items, no item is lost */
+
+/* Item types */
+#define FIFO_ITEM_UDP_20MS  (2)         /* UDP 20ms frame to write */
+#define FIFO_ITEM_LNS_OUT   (3)         /* LNS frames to write */
+#define FIFO_ITEM_CYCLE_END (5)         /* No more items to write in the cycle */
 
 typedef struct fifo_item_s
 {
-    /* TODO : fill the structure with willing elements */
+    uint32_t type;                                      /* Item type (FIFO_ITEM_*) */
+    uint32_t lns_frame_count;                           /* Number of LNS frames */
+    union
+    {
+        uint8_t udp_frame[DRV_UDP_10MS_FRAME_SIZE];     /* UDP frame (10ms or 20ms) */
+        lns_frame_t lns_frames[DRV_MAX_FRAMES];         /* LNS frames */
+    };
 } fifo_item_t;
 
+/**
+ * \brief   Raw UDP frame, payload of a udp_frame fifo
+ */
+typedef struct fifo_udp_frame_s
+{
+    uint8_t frame[DRV_UDP_10MS_FRAME_SIZE];
+} fifo_udp_frame_t;
+
+/**
+ * \brief   Batch of LNS frames, payload of a lns_batch fifo
+ */
+typedef struct fifo_lns_batch_s
+{
+    uint32_t frame_count;
+    lns_frame_t frames[DRV_MAX_FRAMES];
+} fifo_lns_batch_t;
+
+/**
+ * \brief   Items of the ring, reserved by the producer or peeked by the consumer
+ * \details The items may wrap around the end of the ring: the first ones are at first, the others at
+ *          second, the start of the ring. fifo_span_item gives the address of any of them.
+ */
+typedef struct fifo_span_s
+{
+    uint8_t* first;             /* Items up to the end of the ring */
+    uint32_t first_count;
+    uint8_t* second;            /* Items from the start of the ring */
+    uint32_t second_count;
+    uint32_t item_stride;       /* Bytes between two items */
+} fifo_span_t;
+
+/**
+ * \brief       Get the address of an item of a span
+ * \param       span    : Span
+ * \param       index   : Index of the item in the span, lower than first_count + second_count
+ * \return      void* : address of the item
+ */
+static inline void* fifo_span_item(const fifo_span_t* span, uint32_t index)
+{
+    return index < span->first_count ? span->first + (size_t)index * span->item_stride
+                                     : span->second + (size_t)(index - span->first_count) * span->item_stride;
+}
+
 /**
  * \brief   Internal structure of the global FIFO header, used internally by FIFO implementation
  * \details Contains read and write index, but client does not need to know its content
@@ -43,6 +132,222 @@ typedef struct fifo_item_s
  */
 typedef struct hsi_fifo_s hsi_fifo_t;     /* forward declaration for the opaque structure */
 
+/**
+ * \brief       Create a fifo in memory given by the caller
+ * \details     The memory must stay valid while the fifo is used, and isn't freed by fifo_destroy
+ * \param       memory      : Memory of the fifo, aligned on FIFO_ALIGNMENT
+ * \param       size        : Size of the memory, at least FIFO_MEMORY_SIZE(item_size, capacity)
+ * \param       item_size   : Size of an item
+ * \param       capacity    : Number of items, a power of two
+ * \param       policy      : Overflow policy (FIFO_REJECT_NEWEST, FIFO_OVERWRITE_OLDEST or FIFO_BLOCK)
+ * \return      hsi_fifo_t : pointer to fifo structure
+ *                            NULL in case of error: the memory is too small or misaligned, the capacity
+ *                            isn't a power of two or the policy is unknown
+ */
+hsi_fifo_t* fifo_create(void* memory, size_t size, uint32_t item_size, uint32_t capacity, uint32_t policy);
+
+/**
+ * \brief       Create a fifo in huge pages
+ * \details     Explicit huge pages if any are reserved, transparent huge pages otherwise
+ * \param       item_size   : Size of an item
+ * \param       capacity    : Number of items, a power of two
+ * \param       policy      : Overflow policy (FIFO_REJECT_NEWEST, FIFO_OVERWRITE_OLDEST or FIFO_BLOCK)
+ * \return      hsi_fifo_t : pointer to fifo structure, to free with fifo_destroy
+ *                            NULL in case of error (errno is set)
+ */
+hsi_fifo_t* fifo_create_huge(uint32_t item_size, uint32_t capacity, uint32_t policy);
+
+/**
+ * \brief       Destroy a fifo, freeing its memory if it was created by fifo_create_huge
+ * \param       p_fifo  : Pointer to the fifo object
+ */
+void fifo_destroy(hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Copy a data of the item size of the fifo to the fifo
+ * \details     Same as fifo_push, for any item type
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       data    : Pointer on data to push
+ * \return      int32_t : FIFO_DATA if everything is OK
+ *                        FIFO_OVERRUN (fifo full, FIFO_REJECT_NEWEST only)
+ *                        FIFO_FAILURE (pointer null)
+ */
+int32_t fifo_push_data(hsi_fifo_t* p_fifo, const void* data);
+
+/**
+ * \brief       Read one data of the item size of the fifo
+ * \details     Same as fifo_read, for any item type
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param[out]  data    : Pointer on data to set
+ * \return      int32_t : same as fifo_read
+ */
+int32_t fifo_read_data(hsi_fifo_t* p_fifo, void* data);
+
+/**
+ * \brief       Place the read index to the next item, and call fifo_read_data with this new index
+ * \details     Same as fifo_next, for any item type
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param[out]  data    : Pointer on data to set
+ * \return      int32_t : same as fifo_next
+ */
+int32_t fifo_next_data(hsi_fifo_t* p_fifo, void* data);
+
+/**
+ * \brief       Reserve items in the ring, to write them in place (producer)
+ * \details     Reserving again before fifo_commit gives the same items.
+ *              A full fifo follows its overflow policy, the items rejected are counted as lost
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       count   : Number of items, all of them or none are reserved
+ * \param[out]  span    : Items reserved
+ * \return      int32_t : FIFO_DATA if the items are reserved
+ *                        FIFO_OVERRUN (not enough free items, FIFO_REJECT_NEWEST only)
+ *                        FIFO_FAILURE (pointer null or count higher than the capacity)
+ */
+int32_t fifo_reserve(hsi_fifo_t* p_fifo, uint32_t count, fifo_span_t* span);
+
+/**
+ * \brief       Publish the first items reserved to the consumer (producer)
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       count   : Number of items, at most the number reserved
+ */
+void fifo_commit(hsi_fifo_t* p_fifo, uint32_t count);
+
+/**
+ * \brief       Get the items to read in the ring, to read them in place (consumer)
+ * \details     The items stay in the fifo until fifo_release or fifo_next.
+ *              if there was rejected data on push, return special id (FIFO_LOST)
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       max_count   : Maximum number of items
+ * \param[out]  span        : Items to read, at least one if FIFO_DATA is returned
+ * \return      int32_t : FIFO_DATA if items are returned
+ *                        FIFO_EMPTY if fifo is empty
+ *                        FIFO_LOST if there was rejected data on push
+ *                        FIFO_FAILURE if a given pointer is NULL or max_count is 0, or with
+ *                                     FIFO_OVERWRITE_OLDEST, where items can't be read in place
+ */
+int32_t fifo_peek(hsi_fifo_t* p_fifo, uint32_t max_count, fifo_span_t* span);
+
+/**
+ * \brief       Release the first items peeked to the producer (consumer)
+ * \param       p_fifo  : Pointer to the fifo object
+ * \param       count   : Number of items, at most the number peeked
+ */
+void fifo_release(hsi_fifo_t* p_fifo, uint32_t count);
+
+/**
+ * \brief       Get the number of items lost reported by the last FIFO_LOST (consumer)
+ * \param       p_fifo  : Pointer to the fifo object
+ * \return      uint32_t : number of items rejected or overwritten
+ */
+uint32_t fifo_lost_count(const hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Get the number of items lost since the fifo was created
+ * \details     Can be read by any thread, for monitoring
+ * \param       p_fifo  : Pointer to the fifo object
+ * \return      uint64_t : number of items rejected or overwritten
+ */
+uint64_t fifo_lost_total(const hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Wait until the fifo has an item to read (consumer)
+ * \details     Spins shortly, then sleeps on a futex until an item is pushed
+ * \param       p_fifo      : Pointer to the fifo object
+ * \param       timeout_ms  : Maximum time to sleep in ms, -1 to wait without limit
+ * \return      int32_t : FIFO_DATA if there are items to read (or lost items to report)
+ *                        FIFO_EMPTY if the time is out, or the wait was interrupted
+ *                        FIFO_FAILURE if a given pointer is NULL
+ */
+int32_t fifo_wait(hsi_fifo_t* p_fifo, int32_t timeout_ms);
+
+/**
+ * \brief       Get the eventfd written when an item is pushed while the consumer is asleep
+ * \details     Creates it on the first call, before the fifo is used. Added to an epoll set, it is
+ *              readable once the consumer has called fifo_prepare_wait and an item is pushed.
+ * \param       p_fifo  : Pointer to the fifo object
+ * \return      int : the eventfd, -1 in case of error (errno is set)
+ */
+int fifo_notify_fd(hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Announce that the consumer is going to sleep in epoll (consumer)
+ * \details     The consumer sleeps only if FIFO_EMPTY is returned, and calls fifo_finish_wait on wake up
+ * \param       p_fifo  : Pointer to the fifo object
+ * \return      int32_t : FIFO_EMPTY if the consumer may sleep
+ *                        FIFO_DATA if there are items to read, the consumer musn't sleep
+ *                        FIFO_FAILURE if a given pointer is NULL
+ */
+int32_t fifo_prepare_wait(hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Announce that the consumer is awake, and clear the eventfd (consumer)
+ * \param       p_fifo  : Pointer to the fifo object
+ */
+void fifo_finish_wait(hsi_fifo_t* p_fifo);
+
+/**
+ * \brief       Declare a fifo type and its functions for items of a given type
+ * \details     FIFO_DECLARE_TYPED(name, type) declares name##_fifo_t, and the functions name##_fifo_create,
+ *              name##_fifo_create_huge, name##_fifo_destroy, name##_fifo_push, name##_fifo_read and
+ *              name##_fifo_next, which only take a name##_fifo_t and items of that type. Without copy,
+ *              name##_fifo_reserve, name##_fifo_commit, name##_fifo_peek and name##_fifo_release give
+ *              spans whose items name##_fifo_item returns as that type, and name##_fifo_wait sleeps
+ */
+#define FIFO_DECLARE_TYPED(name, type) \
+    typedef struct name##_fifo_s name##_fifo_t; \
+    static inline name##_fifo_t* name##_fifo_create(void* memory, size_t size, uint32_t capacity, \
+                                                    uint32_t policy) \
+    { \
+        return (name##_fifo_t*)fifo_create(memory, size, sizeof(type), capacity, policy); \
+    } \
+    static inline name##_fifo_t* name##_fifo_create_huge(uint32_t capacity, uint32_t policy) \
+    { \
+        return (name##_fifo_t*)fifo_create_huge(sizeof(type), capacity, policy); \
+    } \
+    static inline void name##_fifo_destroy(name##_fifo_t* p_fifo) \
+    { \
+        fifo_destroy((hsi_fifo_t*)p_fifo); \
+    } \
+    static inline int32_t name##_fifo_push(name##_fifo_t* p_fifo, const type* item) \
+    { \
+        return fifo_push_data((hsi_fifo_t*)p_fifo, item); \
+    } \
+    static inline int32_t name##_fifo_read(name##_fifo_t* p_fifo, type* item) \
+    { \
+        return fifo_read_data((hsi_fifo_t*)p_fifo, item); \
+    } \
+    static inline int32_t name##_fifo_next(name##_fifo_t* p_fifo, type* item) \
+    { \
+        return fifo_next_data((hsi_fifo_t*)p_fifo, item); \
+    } \
+    static inline int32_t name##_fifo_reserve(name##_fifo_t* p_fifo, uint32_t count, fifo_span_t* span) \
+    { \
+        return fifo_reserve((hsi_fifo_t*)p_fifo, count, span); \
+    } \
+    static inline void name##_fifo_commit(name##_fifo_t* p_fifo, uint32_t count) \
+    { \
+        fifo_commit((hsi_fifo_t*)p_fifo, count); \
+    } \
+    static inline int32_t name##_fifo_peek(name##_fifo_t* p_fifo, uint32_t max_count, fifo_span_t* span) \
+    { \
+        return fifo_peek((hsi_fifo_t*)p_fifo, max_count, span); \
+    } \
+    static inline void name##_fifo_release(name##_fifo_t* p_fifo, uint32_t count) \
+    { \
+        fifo_release((hsi_fifo_t*)p_fifo, count); \
+    } \
+    static inline int32_t name##_fifo_wait(name##_fifo_t* p_fifo, int32_t timeout_ms) \
+    { \
+        return fifo_wait((hsi_fifo_t*)p_fifo, timeout_ms); \
+    } \
+    static inline type* name##_fifo_item(const fifo_span_t* span, uint32_t index) \
+    { \
+        return (type*)fifo_span_item(span, index); \
+    }
+
+FIFO_DECLARE_TYPED(udp_frame, fifo_udp_frame_t)
+FIFO_DECLARE_TYPED(lns_batch, fifo_lns_batch_t)
+
 /**
  * \brief       Init fifo buffer (Should be used by producer thread)
  * \details     Initialize the fifo struct inside of allocated memory
@@ -58,13 +363,32 @@ hsi_fifo_t* fifo_init(void);
  */
 hsi_fifo_t* fifo_get_pointer(void);
 
+/**
+ * \brief       Init one of the fifo buffers (Should be used by producer thread)
+ * \details     fifo_init() initializes the fifo 0. The fifo holds FIFO_MAX_ITEMS fifo_item_t, and blocks
+ *              the producer when full (FIFO_BLOCK)
+ * \param       id      : Fifo number, lower than FIFO_INSTANCES
+ * \return      hsi_fifo_t : pointer to fifo structure
+ *                            NULL in case of error: the number is too high
+ */
+hsi_fifo_t* fifo_init_instance(uint32_t id);
+
+/**
+ * \brief       Get pointer on one of the fifo structs (Should be used by consumer thread)
+ * \details     fifo_get_pointer() returns the fifo 0
+ * \param       id      : Fifo number, lower than FIFO_INSTANCES
+ * \return      hsi_fifo_t : pointer to fifo structure
+ *                            NULL if the number is too high
+ */
+hsi_fifo_t* fifo_get_instance_pointer(uint32_t id);
+
 /**
  * \brief       Copy a data to fifo
  * \details
  * \param       p_fifo  : Pointer to the fifo object
  * \param       item    : Pointer on item to push
  * \return      int32_t : FIFO_DATA if everything is OK
- *                        FIFO_OVERRUN (fifo full)
+ *                        FIFO_OVERRUN (fifo full, FIFO_REJECT_NEWEST only)
  *                        FIFO_FAILURE (pointer null or reserved ID gived)
  */
 int32_t fifo_push(hsi_fifo_t* p_fifo, const fifo_item_t* item);
@@ -75,6 +399,7 @@ int32_t fifo_push(hsi_fifo_t* p_fifo, const fifo_item_t* item);
  *              if there was rejected data on push, return special id (FIFO_LOST)
  * \param       p_fifo      : Pointer to the fifo object
  * \param[out]  item        : Pointer on item data to set
+ *                            if ret value is  FIFO_LOST : lns_frame_count set to the number of data lost
  * \return      int32_t : FIFO_DATA if a data is returned
  *                        FIFO_EMPTY if fifo is empty
  *                        FIFO_LOST if there was rejected data on push
@@ -87,7 +412,7 @@ int32_t fifo_read(hsi_fifo_t* p_fifo, fifo_item_t* item);
  * \details
  * \param       p_fifo      : Pointer to the fifo object
  * \param[out]  item        : Pointer on item data to set
- *                            if ret value is  FIFO_LOST : number of data lost
+ *                            if ret value is  FIFO_LOST : lns_frame_count set to the number of data lost
  * \return      int32_t : FIFO_DATA if a data is returned
  *                        FIFO_EMPTY  if fifo is empty
  *                        FIFO_LOST if there was rejected data on push
@@ -13,6 +13,7 @@
 #ifndef DATA_DICTIONARY_H
 #define DATA_DICTIONARY_H
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -128,668 +129,2057 @@ typedef enum {
   BATTERY_FLAGS_MASK_FAILURE = 2
 } battery_flags_mask_t;
 
+/**
+ * \brief Ids of the application variables, as defined in variables.csv.
+ */
+typedef enum {
+  VARIABLE_ID_WARNINGS_IN = 1,
+  VARIABLE_ID_SIDELIGHTS_IN = 3,
+  VARIABLE_ID_SIDELIGHTS_OUT = 4,
+  VARIABLE_ID_HEADLIGHTS_IN = 5,
+  VARIABLE_ID_HEADLIGHTS_OUT = 6,
+  VARIABLE_ID_REDLIGHTS_IN = 7,
+  VARIABLE_ID_REDLIGHTS_OUT = 8,
+  VARIABLE_ID_LEFT_BLINKER_IN = 9,
+  VARIABLE_ID_LEFT_BLINKER_OUT = 10,
+  VARIABLE_ID_RIGHT_BLINKER_IN = 11,
+  VARIABLE_ID_RIGHT_BLINKER_OUT = 12,
+  VARIABLE_ID_WIPERS_IN = 13,
+  VARIABLE_ID_WIPERS_OUT = 14,
+  VARIABLE_ID_WASHER_FLUID_IN = 15,
+  VARIABLE_ID_WASHER_FLUID_OUT = 16,
+  VARIABLE_ID_COMMODOS_CRC_8 = 17,
+  VARIABLE_ID_MUX_FRAME_ID = 18,
+  VARIABLE_ID_FRAME_MILEAGE = 19,
+  VARIABLE_ID_FRAME_SPEED = 21,
+  VARIABLE_ID_FRAME_FLAGS = 23,
+  VARIABLE_ID_MOTOR_FLAGS = 24,
+  VARIABLE_ID_TANK_LEVEL = 25,
+  VARIABLE_ID_MOTOR_SPEED = 27,
+  VARIABLE_ID_BATTERY_FLAGS_IN = 29,
+  VARIABLE_ID_INDICATOR_SIDELIGHTS = 30,
+  VARIABLE_ID_INDICATOR_HEADLIGHTS = 31,
+  VARIABLE_ID_INDICATOR_REDLIGHTS = 32,
+  VARIABLE_ID_INDICATOR_LOW_FUEL = 33,
+  VARIABLE_ID_INDICATOR_MOTOR_FAILURE = 34,
+  VARIABLE_ID_INDICATOR_TIRE_PRESSURE = 35,
+  VARIABLE_ID_INDICATOR_PADS_FAILURE = 36,
+  VARIABLE_ID_INDICATOR_BATTERY_LOW = 37,
+  VARIABLE_ID_INDICATOR_WARNINGS = 38,
+  VARIABLE_ID_INDICATOR_BATTERY_FAILURE = 39,
+  VARIABLE_ID_INDICATOR_COOLANT_OVERHEAT = 40,
+  VARIABLE_ID_INDICATOR_MOTOR_PRESSURE = 41,
+  VARIABLE_ID_INDICATOR_OIL_OVERHEAT = 42,
+  VARIABLE_ID_INDICATOR_BRAKE_FAILURE = 43,
+  VARIABLE_ID_FSM_SIDELIGHTS = 44,
+  VARIABLE_ID_FSM_HEADLIGHTS = 45,
+  VARIABLE_ID_FSM_REDLIGHTS = 46,
+  VARIABLE_ID_FSM_LEFT_BLINKER = 47,
+  VARIABLE_ID_FSM_LEFT_BLINKER_TIMER = 48,
+  VARIABLE_ID_FSM_RIGHT_BLINKER = 49,
+  VARIABLE_ID_FSM_RIGHT_BLINKER_TIMER = 50,
+  VARIABLE_ID_FSM_WIPERS = 53,
+  VARIABLE_ID_FSM_WIPERS_TIMER = 54,
+  VARIABLE_ID_SIDELIGHTS_ACKNOWLEDGEMENT = 55,
+  VARIABLE_ID_HEADLIGHTS_ACKNOWLEDGEMENT = 56,
+  VARIABLE_ID_REDLIGHTS_ACKNOWLEDGEMENT = 57,
+  VARIABLE_ID_LEFT_BLINKER_ACKNOWLEDGEMENT = 58,
+  VARIABLE_ID_RIGHT_BLINKER_ACKNOWLEDGEMENT = 59,
+  VARIABLE_ID_FSM_SIDELIGHTS_TIMER = 60,
+  VARIABLE_ID_FSM_HEADLIGHTS_TIMER = 61,
+  VARIABLE_ID_FSM_REDLIGHTS_TIMER = 62
+} variable_id_t;
+
+/**
+ * \brief Number of entries of variable_infos, i.e. highest variable Id + 1.
+ */
+#define VARIABLE_ID_COUNT 63
+
+/**
+ * \brief Total size of the values of the variables, as written by
+ * dd_copy_range().
+ */
+#define VARIABLE_INFOS_SIZE 79
+
+/**
+ * \brief Policies of the setters for the values out of the domain of their
+ * type, as defined in types.csv.
+ */
+typedef enum {
+  DOMAIN_POLICY_REJECT,
+  DOMAIN_POLICY_CLAMP,
+  DOMAIN_POLICY_FLAG
+} domain_policy_t;
+
+/**
+ * \brief Description of a variable of the application data: its Id, name and
+ * type as defined in variables.csv, the offset of its storage in application_t,
+ * the size of its type and storage, its bit in the storage word (-1 if it isn't
+ * stored as a bit), the signedness of its type, its domain with the policy of
+ * its setter and the index of its counter of out of domain values in
+ * application_t (-1 if it has none).
+ */
+struct variable_info_t {
+  variable_id_t id;
+  const char *name;
+  const char *type;
+  uint16_t offset;
+  uint8_t size;
+  uint8_t storage_size;
+  int8_t bit;
+  bool is_signed;
+  int64_t min;
+  int64_t max;
+  domain_policy_t policy;
+  int8_t rejections;
+};
+
+/**
+ * \brief Description of each variable, indexed by Id. Unused Ids have a NULL
+ * name.
+ */
+extern const struct variable_info_t variable_infos[VARIABLE_ID_COUNT];
+
+/**
+ * \brief Application data, only meant to be accessed through the getters and
+ * setters below. Any number of instances can be created and handled with the
+ * *_ctx functions.
+ */
+struct application_t {
+  uint32_t changes[2];
+  uint32_t rejections[3];
+  bool warnings_in;
+  bool sidelights_in;
+  bool sidelights_out;
+  bool sidelights_acknowledgement;
+  bool headlights_in;
+  bool headlights_out;
+  bool headlights_acknowledgement;
+  bool redlights_in;
+  bool redlights_out;
+  bool redlights_acknowledgement;
+  bool left_blinker_in;
+  bool left_blinker_out;
+  bool left_blinker_acknowledgement;
+  bool right_blinker_in;
+  bool right_blinker_out;
+  bool right_blinker_acknowledgement;
+  bool wipers_in;
+  bool wipers_out;
+  bool washer_fluid_in;
+  bool washer_fluid_out;
+  uint8_t commodos_crc_8;
+  uint8_t mux_frame_id;
+  uint32_t frame_mileage;
+  uint8_t frame_speed;
+  uint8_t frame_flags;
+  uint8_t motor_flags;
+  uint8_t tank_level;
+  uint32_t motor_speed;
+  uint8_t battery_flags_in;
+  bool indicator_sidelights;
+  bool indicator_headlights;
+  bool indicator_redlights;
+  bool indicator_low_fuel;
+  bool indicator_motor_failure;
+  bool indicator_tire_pressure;
+  bool indicator_pads_failure;
+  bool indicator_battery_low;
+  bool indicator_warnings;
+  bool indicator_battery_failure;
+  bool indicator_coolant_overheat;
+  bool indicator_motor_pressure;
+  bool indicator_oil_overheat;
+  bool indicator_brake_failure;
+  int32_t fsm_sidelights;
+  uint8_t fsm_sidelights_timer;
+  int32_t fsm_headlights;
+  uint8_t fsm_headlights_timer;
+  int32_t fsm_redlights;
+  uint8_t fsm_redlights_timer;
+  int32_t fsm_left_blinker;
+  uint8_t fsm_left_blinker_timer;
+  int32_t fsm_right_blinker;
+  uint8_t fsm_right_blinker_timer;
+  int32_t fsm_wipers;
+  uint8_t fsm_wipers_timer;
+};
+
+/**
+ * \brief Global instance of the application data, used by the functions without
+ * context.
+ */
+extern struct application_t application;
+
+/**
+ * \brief Magic number of the snapshot files.
+ */
+#define APPLICATION_SNAPSHOT_MAGIC 0x56474342u
+
+/**
+ * \brief Version of the snapshot files, derived from the layout of
+ * application_t.
+ */
+#define APPLICATION_SNAPSHOT_VERSION 0x0a5c6bb3u
+
+/**
+ * \brief Number of slots of a snapshot, written alternately.
+ */
+#define APPLICATION_SNAPSHOT_SLOTS 2
+
+/**
+ * \brief Copy of the application data held by a snapshot. The slot is valid if
+ * its sequence number isn't 0 and its checksum matches its data and sequence
+ * number.
+ */
+struct application_snapshot_slot_t {
+  uint64_t sequence;
+  uint32_t checksum;
+  uint32_t reserved;
+  struct application_t data;
+};
+
+/**
+ * \brief Snapshot of the application data, as mapped from its file. The valid
+ * slot with the highest sequence number holds the last saved application data.
+ */
+struct application_snapshot_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint32_t reserved;
+  struct application_snapshot_slot_t slots[APPLICATION_SNAPSHOT_SLOTS];
+};
+
+/**
+ * \brief Number of slots of a publication, written alternately.
+ */
+#define APPLICATION_PUBLICATION_SLOTS 2
+
+/**
+ * \brief Application data published by a thread for the readers of other
+ * threads. The slot of the last publication is given by its sequence number.
+ * The sequence number is on its own cache line, so that the writes into a slot
+ * don't invalidate the sequence number polled by the readers.
+ */
+struct __attribute__((aligned(64))) application_publication_t {
+  struct application_t slots[APPLICATION_PUBLICATION_SLOTS];
+  uint64_t sequence __attribute__((aligned(64)));
+};
+
+/**
+ * \brief Initializer function for an instance of the application data.
+ * \param[out] ctx Application data to initialize.
+ */
+void application_init_ctx(struct application_t *ctx);
+
 /**
  * \brief Initializer function for the application data.
  */
 void application_init(void);
 
+/**
+ * \brief Tells whether a variable changed value since the last call to
+ * application_clear_changes_ctx().
+ * \param[in] ctx Application data of the instance.
+ * \param[in] id Id of the variable.
+ * \return true if a setter changed the value of the variable, false otherwise.
+ */
+bool application_changed_ctx(const struct application_t *ctx, variable_id_t id);
+
+/**
+ * \brief Tells whether a variable changed value since the last call to
+ * application_clear_changes().
+ * \param[in] id Id of the variable.
+ * \return true if a setter changed the value of the variable, false otherwise.
+ */
+bool application_changed(variable_id_t id);
+
+/**
+ * \brief Iterates over the variables changed since the last call to
+ * application_clear_changes_ctx().
+ * \param[in] ctx Application data of the instance.
+ * \param[in] id Id of the previous changed variable, or -1 to get the first
+ * one.
+ * \return Id of the next changed variable after id, or -1 if there is none.
+ */
+int32_t application_next_change_ctx(const struct application_t *ctx,
+                                    int32_t id);
+
+/**
+ * \brief Iterates over the variables changed since the last call to
+ * application_clear_changes().
+ * \param[in] id Id of the previous changed variable, or -1 to get the first
+ * one.
+ * \return Id of the next changed variable after id, or -1 if there is none.
+ */
+int32_t application_next_change(int32_t id);
+
+/**
+ * \brief Clears the set of changed variables of an instance, to be called at
+ * the start of each cycle.
+ * \param[in,out] ctx Application data of the instance.
+ */
+void application_clear_changes_ctx(struct application_t *ctx);
+
+/**
+ * \brief Clears the set of changed variables, to be called at the start of each
+ * cycle.
+ */
+void application_clear_changes(void);
+
+/**
+ * \brief Getter for ctx->warnings_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the warnings command.
+ */
+command_in_t get_warnings_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.warnings_in.
  * \return Input buffer for the warnings command.
  */
 command_in_t get_warnings_in(void);
 
+/**
+ * \brief Setter for ctx->warnings_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the warnings command.
+ */
+void set_warnings_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.warnings_in.
  * \param[in] value Input buffer for the warnings command.
  */
 void set_warnings_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->sidelights_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the sidelights command.
+ */
+command_in_t get_sidelights_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.sidelights_in.
  * \return Input buffer for the sidelights command.
  */
 command_in_t get_sidelights_in(void);
 
+/**
+ * \brief Setter for ctx->sidelights_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the sidelights command.
+ */
+void set_sidelights_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.sidelights_in.
  * \param[in] value Input buffer for the sidelights command.
  */
 void set_sidelights_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->sidelights_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the sidelights command.
+ */
+command_out_t get_sidelights_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.sidelights_out.
  * \return Output buffer for the sidelights command.
  */
 command_out_t get_sidelights_out(void);
 
+/**
+ * \brief Setter for ctx->sidelights_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the sidelights command.
+ */
+void set_sidelights_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.sidelights_out.
  * \param[in] value Output buffer for the sidelights command.
  */
 void set_sidelights_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->sidelights_acknowledgement.
+ * \param[in] ctx Application data of the instance.
+ * \return Acknowledgement for the sidelights command message.
+ */
+acknowledgement_t
+get_sidelights_acknowledgement_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.sidelights_acknowledgement.
  * \return Acknowledgement for the sidelights command message.
  */
 acknowledgement_t get_sidelights_acknowledgement(void);
 
+/**
+ * \brief Setter for ctx->sidelights_acknowledgement.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Acknowledgement for the sidelights command message.
+ */
+void set_sidelights_acknowledgement_ctx(struct application_t *ctx,
+                                        acknowledgement_t value);
+
 /**
  * \brief Setter for application.sidelights_acknowledgement.
  * \param[in] value Acknowledgement for the sidelights command message.
  */
 void set_sidelights_acknowledgement(acknowledgement_t value);
 
+/**
+ * \brief Getter for ctx->headlights_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the headlights command.
+ */
+command_in_t get_headlights_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.headlights_in.
  * \return Input buffer for the headlights command.
  */
 command_in_t get_headlights_in(void);
 
+/**
+ * \brief Setter for ctx->headlights_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the headlights command.
+ */
+void set_headlights_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.headlights_in.
  * \param[in] value Input buffer for the headlights command.
  */
 void set_headlights_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->headlights_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the headlight command.
+ */
+command_out_t get_headlights_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.headlights_out.
  * \return Output buffer for the headlight command.
  */
 command_out_t get_headlights_out(void);
 
+/**
+ * \brief Setter for ctx->headlights_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the headlight command.
+ */
+void set_headlights_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.headlights_out.
  * \param[in] value Output buffer for the headlight command.
  */
 void set_headlights_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->headlights_acknowledgement.
+ * \param[in] ctx Application data of the instance.
+ * \return Acknowledgement for the headlights command message.
+ */
+acknowledgement_t
+get_headlights_acknowledgement_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.headlights_acknowledgement.
  * \return Acknowledgement for the headlights command message.
  */
 acknowledgement_t get_headlights_acknowledgement(void);
 
+/**
+ * \brief Setter for ctx->headlights_acknowledgement.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Acknowledgement for the headlights command message.
+ */
+void set_headlights_acknowledgement_ctx(struct application_t *ctx,
+                                        acknowledgement_t value);
+
 /**
  * \brief Setter for application.headlights_acknowledgement.
  * \param[in] value Acknowledgement for the headlights command message.
  */
 void set_headlights_acknowledgement(acknowledgement_t value);
 
+/**
+ * \brief Getter for ctx->redlights_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the redlights command.
+ */
+command_in_t get_redlights_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.redlights_in.
  * \return Input buffer for the redlights command.
  */
 command_in_t get_redlights_in(void);
 
+/**
+ * \brief Setter for ctx->redlights_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the redlights command.
+ */
+void set_redlights_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.redlights_in.
  * \param[in] value Input buffer for the redlights command.
  */
 void set_redlights_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->redlights_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the redlights command.
+ */
+command_out_t get_redlights_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.redlights_out.
  * \return Output buffer for the redlights command.
  */
 command_out_t get_redlights_out(void);
 
+/**
+ * \brief Setter for ctx->redlights_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the redlights command.
+ */
+void set_redlights_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.redlights_out.
  * \param[in] value Output buffer for the redlights command.
  */
 void set_redlights_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->redlights_acknowledgement.
+ * \param[in] ctx Application data of the instance.
+ * \return Acknowledgement for the redlights command message.
+ */
+acknowledgement_t
+get_redlights_acknowledgement_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.redlights_acknowledgement.
  * \return Acknowledgement for the redlights command message.
  */
 acknowledgement_t get_redlights_acknowledgement(void);
 
+/**
+ * \brief Setter for ctx->redlights_acknowledgement.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Acknowledgement for the redlights command message.
+ */
+void set_redlights_acknowledgement_ctx(struct application_t *ctx,
+                                       acknowledgement_t value);
+
 /**
  * \brief Setter for application.redlights_acknowledgement.
  * \param[in] value Acknowledgement for the redlights command message.
  */
 void set_redlights_acknowledgement(acknowledgement_t value);
 
+/**
+ * \brief Getter for ctx->left_blinker_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the left blinker command.
+ */
+command_in_t get_left_blinker_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.left_blinker_in.
  * \return Input buffer for the left blinker command.
  */
 command_in_t get_left_blinker_in(void);
 
+/**
+ * \brief Setter for ctx->left_blinker_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the left blinker command.
+ */
+void set_left_blinker_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.left_blinker_in.
  * \param[in] value Input buffer for the left blinker command.
  */
 void set_left_blinker_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->left_blinker_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the left blinker command.
+ */
+command_out_t get_left_blinker_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.left_blinker_out.
  * \return Output buffer for the left blinker command.
  */
 command_out_t get_left_blinker_out(void);
 
+/**
+ * \brief Setter for ctx->left_blinker_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the left blinker command.
+ */
+void set_left_blinker_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.left_blinker_out.
  * \param[in] value Output buffer for the left blinker command.
  */
 void set_left_blinker_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->left_blinker_acknowledgement.
+ * \param[in] ctx Application data of the instance.
+ * \return Acknowledgement for the left blinker command message.
+ */
+acknowledgement_t
+get_left_blinker_acknowledgement_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.left_blinker_acknowledgement.
  * \return Acknowledgement for the left blinker command message.
  */
 acknowledgement_t get_left_blinker_acknowledgement(void);
 
+/**
+ * \brief Setter for ctx->left_blinker_acknowledgement.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Acknowledgement for the left blinker command message.
+ */
+void set_left_blinker_acknowledgement_ctx(struct application_t *ctx,
+                                          acknowledgement_t value);
+
 /**
  * \brief Setter for application.left_blinker_acknowledgement.
  * \param[in] value Acknowledgement for the left blinker command message.
  */
 void set_left_blinker_acknowledgement(acknowledgement_t value);
 
+/**
+ * \brief Getter for ctx->right_blinker_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the right blinker command.
+ */
+command_in_t get_right_blinker_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.right_blinker_in.
  * \return Input buffer for the right blinker command.
  */
 command_in_t get_right_blinker_in(void);
 
+/**
+ * \brief Setter for ctx->right_blinker_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the right blinker command.
+ */
+void set_right_blinker_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.right_blinker_in.
  * \param[in] value Input buffer for the right blinker command.
  */
 void set_right_blinker_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->right_blinker_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the right blinker command.
+ */
+command_out_t get_right_blinker_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.right_blinker_out.
  * \return Output buffer for the right blinker command.
  */
 command_out_t get_right_blinker_out(void);
 
+/**
+ * \brief Setter for ctx->right_blinker_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the right blinker command.
+ */
+void set_right_blinker_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.right_blinker_out.
  * \param[in] value Output buffer for the right blinker command.
  */
 void set_right_blinker_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->right_blinker_acknowledgement.
+ * \param[in] ctx Application data of the instance.
+ * \return Acknowledgement for the right blinker command message.
+ */
+acknowledgement_t
+get_right_blinker_acknowledgement_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.right_blinker_acknowledgement.
  * \return Acknowledgement for the right blinker command message.
  */
 acknowledgement_t get_right_blinker_acknowledgement(void);
 
+/**
+ * \brief Setter for ctx->right_blinker_acknowledgement.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Acknowledgement for the right blinker command message.
+ */
+void set_right_blinker_acknowledgement_ctx(struct application_t *ctx,
+                                           acknowledgement_t value);
+
 /**
  * \brief Setter for application.right_blinker_acknowledgement.
  * \param[in] value Acknowledgement for the right blinker command message.
  */
 void set_right_blinker_acknowledgement(acknowledgement_t value);
 
+/**
+ * \brief Getter for ctx->wipers_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the wipers command.
+ */
+command_in_t get_wipers_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.wipers_in.
  * \return Input buffer for the wipers command.
  */
 command_in_t get_wipers_in(void);
 
+/**
+ * \brief Setter for ctx->wipers_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the wipers command.
+ */
+void set_wipers_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.wipers_in.
  * \param[in] value Input buffer for the wipers command.
  */
 void set_wipers_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->wipers_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the wipers command.
+ */
+command_out_t get_wipers_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.wipers_out.
  * \return Output buffer for the wipers command.
  */
 command_out_t get_wipers_out(void);
 
+/**
+ * \brief Setter for ctx->wipers_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the wipers command.
+ */
+void set_wipers_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.wipers_out.
  * \param[in] value Output buffer for the wipers command.
  */
 void set_wipers_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->washer_fluid_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the washer fluid command.
+ */
+command_in_t get_washer_fluid_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.washer_fluid_in.
  * \return Input buffer for the washer fluid command.
  */
 command_in_t get_washer_fluid_in(void);
 
+/**
+ * \brief Setter for ctx->washer_fluid_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the washer fluid command.
+ */
+void set_washer_fluid_in_ctx(struct application_t *ctx, command_in_t value);
+
 /**
  * \brief Setter for application.washer_fluid_in.
  * \param[in] value Input buffer for the washer fluid command.
  */
 void set_washer_fluid_in(command_in_t value);
 
+/**
+ * \brief Getter for ctx->washer_fluid_out.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the washer fluid command.
+ */
+command_out_t get_washer_fluid_out_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.washer_fluid_out.
  * \return Output buffer for the washer fluid command.
  */
 command_out_t get_washer_fluid_out(void);
 
+/**
+ * \brief Setter for ctx->washer_fluid_out.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the washer fluid command.
+ */
+void set_washer_fluid_out_ctx(struct application_t *ctx, command_out_t value);
+
 /**
  * \brief Setter for application.washer_fluid_out.
  * \param[in] value Output buffer for the washer fluid command.
  */
 void set_washer_fluid_out(command_out_t value);
 
+/**
+ * \brief Getter for ctx->commodos_crc_8.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the commodos' sent CRC8 code.
+ */
+crc_8_t get_commodos_crc_8_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.commodos_crc_8.
  * \return Input buffer for the commodos' sent CRC8 code.
  */
 crc_8_t get_commodos_crc_8(void);
 
+/**
+ * \brief Setter for ctx->commodos_crc_8.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the commodos' sent CRC8 code.
+ */
+void set_commodos_crc_8_ctx(struct application_t *ctx, crc_8_t value);
+
 /**
  * \brief Setter for application.commodos_crc_8.
  * \param[in] value Input buffer for the commodos' sent CRC8 code.
  */
 void set_commodos_crc_8(crc_8_t value);
 
+/**
+ * \brief Getter for ctx->mux_frame_id.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the MUX frame ID.
+ */
+mux_id_t get_mux_frame_id_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.mux_frame_id.
  * \return Input buffer for the MUX frame ID.
  */
 mux_id_t get_mux_frame_id(void);
 
+/**
+ * \brief Setter for ctx->mux_frame_id.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the MUX frame ID.
+ */
+void set_mux_frame_id_ctx(struct application_t *ctx, mux_id_t value);
+
 /**
  * \brief Setter for application.mux_frame_id.
  * \param[in] value Input buffer for the MUX frame ID.
  */
 void set_mux_frame_id(mux_id_t value);
 
+/**
+ * \brief Getter for the number of out of domain values written into
+ * ctx->mux_frame_id.
+ * \param[in] ctx Application data of the instance.
+ * \return Number of out of domain values, handled by the reject policy of
+ * mux_id_t.
+ */
+uint32_t get_mux_frame_id_rejections_ctx(const struct application_t *ctx);
+
+/**
+ * \brief Getter for the number of out of domain values written into
+ * application.mux_frame_id.
+ * \return Number of out of domain values, handled by the reject policy of
+ * mux_id_t.
+ */
+uint32_t get_mux_frame_id_rejections(void);
+
+/**
+ * \brief Getter for ctx->frame_mileage.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s mileage.
+ */
+frame_mileage_t get_frame_mileage_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.frame_mileage.
  * \return Input buffer for the vehicle’s mileage.
  */
 frame_mileage_t get_frame_mileage(void);
 
+/**
+ * \brief Setter for ctx->frame_mileage.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s mileage.
+ */
+void set_frame_mileage_ctx(struct application_t *ctx, frame_mileage_t value);
+
 /**
  * \brief Setter for application.frame_mileage.
  * \param[in] value Input buffer for the vehicle’s mileage.
  */
 void set_frame_mileage(frame_mileage_t value);
 
+/**
+ * \brief Getter for ctx->frame_speed.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s speed.
+ */
+frame_speed_t get_frame_speed_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.frame_speed.
  * \return Input buffer for the vehicle’s speed.
  */
 frame_speed_t get_frame_speed(void);
 
+/**
+ * \brief Setter for ctx->frame_speed.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s speed.
+ */
+void set_frame_speed_ctx(struct application_t *ctx, frame_speed_t value);
+
 /**
  * \brief Setter for application.frame_speed.
  * \param[in] value Input buffer for the vehicle’s speed.
  */
 void set_frame_speed(frame_speed_t value);
 
+/**
+ * \brief Getter for ctx->frame_flags.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s frame status information.
+ */
+frame_flags_t get_frame_flags_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.frame_flags.
  * \return Input buffer for the vehicle’s frame status information.
  */
 frame_flags_t get_frame_flags(void);
 
+/**
+ * \brief Setter for ctx->frame_flags.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s frame status information.
+ */
+void set_frame_flags_ctx(struct application_t *ctx, frame_flags_t value);
+
 /**
  * \brief Setter for application.frame_flags.
  * \param[in] value Input buffer for the vehicle’s frame status information.
  */
 void set_frame_flags(frame_flags_t value);
 
+/**
+ * \brief Getter for ctx->motor_flags.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s motor status information.
+ */
+motor_flags_t get_motor_flags_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.motor_flags.
  * \return Input buffer for the vehicle’s motor status information.
  */
 motor_flags_t get_motor_flags(void);
 
+/**
+ * \brief Setter for ctx->motor_flags.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s motor status information.
+ */
+void set_motor_flags_ctx(struct application_t *ctx, motor_flags_t value);
+
 /**
  * \brief Setter for application.motor_flags.
  * \param[in] value Input buffer for the vehicle’s motor status information.
  */
 void set_motor_flags(motor_flags_t value);
 
+/**
+ * \brief Getter for ctx->tank_level.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s tank fuel level.
+ */
+tank_level_t get_tank_level_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.tank_level.
  * \return Input buffer for the vehicle’s tank fuel level.
  */
 tank_level_t get_tank_level(void);
 
+/**
+ * \brief Setter for ctx->tank_level.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s tank fuel level.
+ */
+void set_tank_level_ctx(struct application_t *ctx, tank_level_t value);
+
 /**
  * \brief Setter for application.tank_level.
  * \param[in] value Input buffer for the vehicle’s tank fuel level.
  */
 void set_tank_level(tank_level_t value);
 
+/**
+ * \brief Getter for the number of out of domain values written into
+ * ctx->tank_level.
+ * \param[in] ctx Application data of the instance.
+ * \return Number of out of domain values, handled by the reject policy of
+ * tank_level_t.
+ */
+uint32_t get_tank_level_rejections_ctx(const struct application_t *ctx);
+
+/**
+ * \brief Getter for the number of out of domain values written into
+ * application.tank_level.
+ * \return Number of out of domain values, handled by the reject policy of
+ * tank_level_t.
+ */
+uint32_t get_tank_level_rejections(void);
+
+/**
+ * \brief Getter for ctx->motor_speed.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s motor speed.
+ */
+motor_speed_t get_motor_speed_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.motor_speed.
  * \return Input buffer for the vehicle’s motor speed.
  */
 motor_speed_t get_motor_speed(void);
 
+/**
+ * \brief Setter for ctx->motor_speed.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s motor speed.
+ */
+void set_motor_speed_ctx(struct application_t *ctx, motor_speed_t value);
+
 /**
  * \brief Setter for application.motor_speed.
  * \param[in] value Input buffer for the vehicle’s motor speed.
  */
 void set_motor_speed(motor_speed_t value);
 
+/**
+ * \brief Getter for the number of out of domain values written into
+ * ctx->motor_speed.
+ * \param[in] ctx Application data of the instance.
+ * \return Number of out of domain values, handled by the reject policy of
+ * motor_speed_t.
+ */
+uint32_t get_motor_speed_rejections_ctx(const struct application_t *ctx);
+
+/**
+ * \brief Getter for the number of out of domain values written into
+ * application.motor_speed.
+ * \return Number of out of domain values, handled by the reject policy of
+ * motor_speed_t.
+ */
+uint32_t get_motor_speed_rejections(void);
+
+/**
+ * \brief Getter for ctx->battery_flags_in.
+ * \param[in] ctx Application data of the instance.
+ * \return Input buffer for the vehicle’s battery status information.
+ */
+battery_flags_t get_battery_flags_in_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.battery_flags_in.
  * \return Input buffer for the vehicle’s battery status information.
  */
 battery_flags_t get_battery_flags_in(void);
 
+/**
+ * \brief Setter for ctx->battery_flags_in.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Input buffer for the vehicle’s battery status information.
+ */
+void set_battery_flags_in_ctx(struct application_t *ctx, battery_flags_t value);
+
 /**
  * \brief Setter for application.battery_flags_in.
  * \param[in] value Input buffer for the vehicle’s battery status information.
  */
 void set_battery_flags_in(battery_flags_t value);
 
+/**
+ * \brief Getter for ctx->indicator_sidelights.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the sidelights indicator.
+ */
+indicator_t get_indicator_sidelights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_sidelights.
  * \return Output buffer for the sidelights indicator.
  */
 indicator_t get_indicator_sidelights(void);
 
+/**
+ * \brief Setter for ctx->indicator_sidelights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the sidelights indicator.
+ */
+void set_indicator_sidelights_ctx(struct application_t *ctx, indicator_t value);
+
 /**
  * \brief Setter for application.indicator_sidelights.
  * \param[in] value Output buffer for the sidelights indicator.
  */
 void set_indicator_sidelights(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_headlights.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the headlight indicator.
+ */
+indicator_t get_indicator_headlights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_headlights.
  * \return Output buffer for the headlight indicator.
  */
 indicator_t get_indicator_headlights(void);
 
+/**
+ * \brief Setter for ctx->indicator_headlights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the headlight indicator.
+ */
+void set_indicator_headlights_ctx(struct application_t *ctx, indicator_t value);
+
 /**
  * \brief Setter for application.indicator_headlights.
  * \param[in] value Output buffer for the headlight indicator.
  */
 void set_indicator_headlights(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_redlights.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the redlights indicator.
+ */
+indicator_t get_indicator_redlights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_redlights.
  * \return Output buffer for the redlights indicator.
  */
 indicator_t get_indicator_redlights(void);
 
+/**
+ * \brief Setter for ctx->indicator_redlights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the redlights indicator.
+ */
+void set_indicator_redlights_ctx(struct application_t *ctx, indicator_t value);
+
 /**
  * \brief Setter for application.indicator_redlights.
  * \param[in] value Output buffer for the redlights indicator.
  */
 void set_indicator_redlights(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_low_fuel.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the low fuel indicator.
+ */
+indicator_t get_indicator_low_fuel_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_low_fuel.
  * \return Output buffer for the low fuel indicator.
  */
 indicator_t get_indicator_low_fuel(void);
 
+/**
+ * \brief Setter for ctx->indicator_low_fuel.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the low fuel indicator.
+ */
+void set_indicator_low_fuel_ctx(struct application_t *ctx, indicator_t value);
+
 /**
  * \brief Setter for application.indicator_low_fuel.
  * \param[in] value Output buffer for the low fuel indicator.
  */
 void set_indicator_low_fuel(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_motor_failure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the motor failure indicator.
+ */
+indicator_t get_indicator_motor_failure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_motor_failure.
  * \return Output buffer for the motor failure indicator.
  */
 indicator_t get_indicator_motor_failure(void);
 
+/**
+ * \brief Setter for ctx->indicator_motor_failure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the motor failure indicator.
+ */
+void set_indicator_motor_failure_ctx(struct application_t *ctx,
+                                     indicator_t value);
+
 /**
  * \brief Setter for application.indicator_motor_failure.
  * \param[in] value Output buffer for the motor failure indicator.
  */
 void set_indicator_motor_failure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_tire_pressure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the low tire pressure indicator.
+ */
+indicator_t get_indicator_tire_pressure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_tire_pressure.
  * \return Output buffer for the low tire pressure indicator.
  */
 indicator_t get_indicator_tire_pressure(void);
 
+/**
+ * \brief Setter for ctx->indicator_tire_pressure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the low tire pressure indicator.
+ */
+void set_indicator_tire_pressure_ctx(struct application_t *ctx,
+                                     indicator_t value);
+
 /**
  * \brief Setter for application.indicator_tire_pressure.
  * \param[in] value Output buffer for the low tire pressure indicator.
  */
 void set_indicator_tire_pressure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_pads_failure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the brake pads failure indicator.
+ */
+indicator_t get_indicator_pads_failure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_pads_failure.
  * \return Output buffer for the brake pads failure indicator.
  */
 indicator_t get_indicator_pads_failure(void);
 
+/**
+ * \brief Setter for ctx->indicator_pads_failure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the brake pads failure indicator.
+ */
+void set_indicator_pads_failure_ctx(struct application_t *ctx,
+                                    indicator_t value);
+
 /**
  * \brief Setter for application.indicator_pads_failure.
  * \param[in] value Output buffer for the brake pads failure indicator.
  */
 void set_indicator_pads_failure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_battery_low.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the battery low indicator.
+ */
+indicator_t get_indicator_battery_low_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_battery_low.
  * \return Output buffer for the battery low indicator.
  */
 indicator_t get_indicator_battery_low(void);
 
+/**
+ * \brief Setter for ctx->indicator_battery_low.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the battery low indicator.
+ */
+void set_indicator_battery_low_ctx(struct application_t *ctx,
+                                   indicator_t value);
+
 /**
  * \brief Setter for application.indicator_battery_low.
  * \param[in] value Output buffer for the battery low indicator.
  */
 void set_indicator_battery_low(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_warnings.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the warnings indicator.
+ */
+indicator_t get_indicator_warnings_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_warnings.
  * \return Output buffer for the warnings indicator.
  */
 indicator_t get_indicator_warnings(void);
 
+/**
+ * \brief Setter for ctx->indicator_warnings.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the warnings indicator.
+ */
+void set_indicator_warnings_ctx(struct application_t *ctx, indicator_t value);
+
 /**
  * \brief Setter for application.indicator_warnings.
  * \param[in] value Output buffer for the warnings indicator.
  */
 void set_indicator_warnings(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_battery_failure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the battery failure indicator.
+ */
+indicator_t get_indicator_battery_failure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_battery_failure.
  * \return Output buffer for the battery failure indicator.
  */
 indicator_t get_indicator_battery_failure(void);
 
+/**
+ * \brief Setter for ctx->indicator_battery_failure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the battery failure indicator.
+ */
+void set_indicator_battery_failure_ctx(struct application_t *ctx,
+                                       indicator_t value);
+
 /**
  * \brief Setter for application.indicator_battery_failure.
  * \param[in] value Output buffer for the battery failure indicator.
  */
 void set_indicator_battery_failure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_coolant_overheat.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the coolant overheat indicator.
+ */
+indicator_t get_indicator_coolant_overheat_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_coolant_overheat.
  * \return Output buffer for the coolant overheat indicator.
  */
 indicator_t get_indicator_coolant_overheat(void);
 
+/**
+ * \brief Setter for ctx->indicator_coolant_overheat.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the coolant overheat indicator.
+ */
+void set_indicator_coolant_overheat_ctx(struct application_t *ctx,
+                                        indicator_t value);
+
 /**
  * \brief Setter for application.indicator_coolant_overheat.
  * \param[in] value Output buffer for the coolant overheat indicator.
  */
 void set_indicator_coolant_overheat(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_motor_pressure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the motor pressure indicator.
+ */
+indicator_t get_indicator_motor_pressure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_motor_pressure.
  * \return Output buffer for the motor pressure indicator.
  */
 indicator_t get_indicator_motor_pressure(void);
 
+/**
+ * \brief Setter for ctx->indicator_motor_pressure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the motor pressure indicator.
+ */
+void set_indicator_motor_pressure_ctx(struct application_t *ctx,
+                                      indicator_t value);
+
 /**
  * \brief Setter for application.indicator_motor_pressure.
  * \param[in] value Output buffer for the motor pressure indicator.
  */
 void set_indicator_motor_pressure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_oil_overheat.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the oil overhead indicator.
+ */
+indicator_t get_indicator_oil_overheat_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_oil_overheat.
  * \return Output buffer for the oil overhead indicator.
  */
 indicator_t get_indicator_oil_overheat(void);
 
+/**
+ * \brief Setter for ctx->indicator_oil_overheat.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the oil overhead indicator.
+ */
+void set_indicator_oil_overheat_ctx(struct application_t *ctx,
+                                    indicator_t value);
+
 /**
  * \brief Setter for application.indicator_oil_overheat.
  * \param[in] value Output buffer for the oil overhead indicator.
  */
 void set_indicator_oil_overheat(indicator_t value);
 
+/**
+ * \brief Getter for ctx->indicator_brake_failure.
+ * \param[in] ctx Application data of the instance.
+ * \return Output buffer for the brake failure indicator.
+ */
+indicator_t get_indicator_brake_failure_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.indicator_brake_failure.
  * \return Output buffer for the brake failure indicator.
  */
 indicator_t get_indicator_brake_failure(void);
 
+/**
+ * \brief Setter for ctx->indicator_brake_failure.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Output buffer for the brake failure indicator.
+ */
+void set_indicator_brake_failure_ctx(struct application_t *ctx,
+                                     indicator_t value);
+
 /**
  * \brief Setter for application.indicator_brake_failure.
  * \param[in] value Output buffer for the brake failure indicator.
  */
 void set_indicator_brake_failure(indicator_t value);
 
+/**
+ * \brief Getter for ctx->fsm_sidelights.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the sidelights.
+ */
+fsm_lights_t get_fsm_sidelights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_sidelights.
  * \return Current state of the FSM for the sidelights.
  */
 fsm_lights_t get_fsm_sidelights(void);
 
+/**
+ * \brief Setter for ctx->fsm_sidelights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the sidelights.
+ */
+void set_fsm_sidelights_ctx(struct application_t *ctx, fsm_lights_t value);
+
 /**
  * \brief Setter for application.fsm_sidelights.
  * \param[in] value Current state of the FSM for the sidelights.
  */
 void set_fsm_sidelights(fsm_lights_t value);
 
+/**
+ * \brief Getter for ctx->fsm_sidelights_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the sidelights FSM.
+ */
+fsm_timer_t get_fsm_sidelights_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_sidelights_timer.
  * \return Timer for the sidelights FSM.
  */
 fsm_timer_t get_fsm_sidelights_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_sidelights_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the sidelights FSM.
+ */
+void set_fsm_sidelights_timer_ctx(struct application_t *ctx, fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_sidelights_timer.
  * \param[in] value Timer for the sidelights FSM.
  */
 void set_fsm_sidelights_timer(fsm_timer_t value);
 
+/**
+ * \brief Getter for ctx->fsm_headlights.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the headlights.
+ */
+fsm_lights_t get_fsm_headlights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_headlights.
  * \return Current state of the FSM for the headlights.
  */
 fsm_lights_t get_fsm_headlights(void);
 
+/**
+ * \brief Setter for ctx->fsm_headlights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the headlights.
+ */
+void set_fsm_headlights_ctx(struct application_t *ctx, fsm_lights_t value);
+
 /**
  * \brief Setter for application.fsm_headlights.
  * \param[in] value Current state of the FSM for the headlights.
  */
 void set_fsm_headlights(fsm_lights_t value);
 
+/**
+ * \brief Getter for ctx->fsm_headlights_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the headlights FSM.
+ */
+fsm_timer_t get_fsm_headlights_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_headlights_timer.
  * \return Timer for the headlights FSM.
  */
 fsm_timer_t get_fsm_headlights_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_headlights_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the headlights FSM.
+ */
+void set_fsm_headlights_timer_ctx(struct application_t *ctx, fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_headlights_timer.
  * \param[in] value Timer for the headlights FSM.
  */
 void set_fsm_headlights_timer(fsm_timer_t value);
 
+/**
+ * \brief Getter for ctx->fsm_redlights.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the redlights.
+ */
+fsm_lights_t get_fsm_redlights_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_redlights.
  * \return Current state of the FSM for the redlights.
  */
 fsm_lights_t get_fsm_redlights(void);
 
+/**
+ * \brief Setter for ctx->fsm_redlights.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the redlights.
+ */
+void set_fsm_redlights_ctx(struct application_t *ctx, fsm_lights_t value);
+
 /**
  * \brief Setter for application.fsm_redlights.
  * \param[in] value Current state of the FSM for the redlights.
  */
 void set_fsm_redlights(fsm_lights_t value);
 
+/**
+ * \brief Getter for ctx->fsm_redlights_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the redlights FSM.
+ */
+fsm_timer_t get_fsm_redlights_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_redlights_timer.
  * \return Timer for the redlights FSM.
  */
 fsm_timer_t get_fsm_redlights_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_redlights_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the redlights FSM.
+ */
+void set_fsm_redlights_timer_ctx(struct application_t *ctx, fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_redlights_timer.
  * \param[in] value Timer for the redlights FSM.
  */
 void set_fsm_redlights_timer(fsm_timer_t value);
 
+/**
+ * \brief Getter for ctx->fsm_left_blinker.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the left blinker.
+ */
+fsm_blinkers_t get_fsm_left_blinker_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_left_blinker.
  * \return Current state of the FSM for the left blinker.
  */
 fsm_blinkers_t get_fsm_left_blinker(void);
 
+/**
+ * \brief Setter for ctx->fsm_left_blinker.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the left blinker.
+ */
+void set_fsm_left_blinker_ctx(struct application_t *ctx, fsm_blinkers_t value);
+
 /**
  * \brief Setter for application.fsm_left_blinker.
  * \param[in] value Current state of the FSM for the left blinker.
  */
 void set_fsm_left_blinker(fsm_blinkers_t value);
 
+/**
+ * \brief Getter for ctx->fsm_left_blinker_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the left blinker FSM.
+ */
+fsm_timer_t get_fsm_left_blinker_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_left_blinker_timer.
  * \return Timer for the left blinker FSM.
  */
 fsm_timer_t get_fsm_left_blinker_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_left_blinker_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the left blinker FSM.
+ */
+void set_fsm_left_blinker_timer_ctx(struct application_t *ctx,
+                                    fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_left_blinker_timer.
  * \param[in] value Timer for the left blinker FSM.
  */
 void set_fsm_left_blinker_timer(fsm_timer_t value);
 
+/**
+ * \brief Getter for ctx->fsm_right_blinker.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the right blinker.
+ */
+fsm_blinkers_t get_fsm_right_blinker_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_right_blinker.
  * \return Current state of the FSM for the right blinker.
  */
 fsm_blinkers_t get_fsm_right_blinker(void);
 
+/**
+ * \brief Setter for ctx->fsm_right_blinker.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the right blinker.
+ */
+void set_fsm_right_blinker_ctx(struct application_t *ctx, fsm_blinkers_t value);
+
 /**
  * \brief Setter for application.fsm_right_blinker.
  * \param[in] value Current state of the FSM for the right blinker.
  */
 void set_fsm_right_blinker(fsm_blinkers_t value);
 
+/**
+ * \brief Getter for ctx->fsm_right_blinker_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the right blinker FSM.
+ */
+fsm_timer_t get_fsm_right_blinker_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_right_blinker_timer.
  * \return Timer for the right blinker FSM.
  */
 fsm_timer_t get_fsm_right_blinker_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_right_blinker_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the right blinker FSM.
+ */
+void set_fsm_right_blinker_timer_ctx(struct application_t *ctx,
+                                     fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_right_blinker_timer.
  * \param[in] value Timer for the right blinker FSM.
  */
 void set_fsm_right_blinker_timer(fsm_timer_t value);
 
+/**
+ * \brief Getter for ctx->fsm_wipers.
+ * \param[in] ctx Application data of the instance.
+ * \return Current state of the FSM for the wipers.
+ */
+fsm_wipers_t get_fsm_wipers_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_wipers.
  * \return Current state of the FSM for the wipers.
  */
 fsm_wipers_t get_fsm_wipers(void);
 
+/**
+ * \brief Setter for ctx->fsm_wipers.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Current state of the FSM for the wipers.
+ */
+void set_fsm_wipers_ctx(struct application_t *ctx, fsm_wipers_t value);
+
 /**
  * \brief Setter for application.fsm_wipers.
  * \param[in] value Current state of the FSM for the wipers.
  */
 void set_fsm_wipers(fsm_wipers_t value);
 
+/**
+ * \brief Getter for ctx->fsm_wipers_timer.
+ * \param[in] ctx Application data of the instance.
+ * \return Timer for the wipers FSM.
+ */
+fsm_timer_t get_fsm_wipers_timer_ctx(const struct application_t *ctx);
+
 /**
  * \brief Getter for application.fsm_wipers_timer.
  * \return Timer for the wipers FSM.
  */
 fsm_timer_t get_fsm_wipers_timer(void);
 
+/**
+ * \brief Setter for ctx->fsm_wipers_timer.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] value Timer for the wipers FSM.
+ */
+void set_fsm_wipers_timer_ctx(struct application_t *ctx, fsm_timer_t value);
+
 /**
  * \brief Setter for application.fsm_wipers_timer.
  * \param[in] value Timer for the wipers FSM.
  */
 void set_fsm_wipers_timer(fsm_timer_t value);
+
+/**
+ * \brief Reads any variable of the application data of an instance.
+ * \param[in] ctx Application data of the instance.
+ * \param[in] id Id of the variable.
+ * \param[out] buf Buffer of variable_infos[id].size bytes, receiving the value
+ * of the variable as its type.
+ * \return true if the variable was read, false if id isn't a variable Id.
+ */
+bool dd_read_ctx(const struct application_t *ctx, variable_id_t id, void *buf);
+
+/**
+ * \brief Reads any variable of the application data.
+ * \param[in] id Id of the variable.
+ * \param[out] buf Buffer of variable_infos[id].size bytes, receiving the value
+ * of the variable as its type.
+ * \return true if the variable was read, false if id isn't a variable Id.
+ */
+bool dd_read(variable_id_t id, void *buf);
+
+/**
+ * \brief Writes any variable of the application data of an instance, as its
+ * setter does.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] id Id of the variable.
+ * \param[in] buf Buffer of variable_infos[id].size bytes, holding the value of
+ * the variable as its type.
+ * \return true if the variable was written, false if id isn't a variable Id or
+ * the value is out of the domain of the variable and rejected by its policy.
+ */
+bool dd_write_ctx(struct application_t *ctx, variable_id_t id, const void *buf);
+
+/**
+ * \brief Writes any variable of the application data, as its setter does.
+ * \param[in] id Id of the variable.
+ * \param[in] buf Buffer of variable_infos[id].size bytes, holding the value of
+ * the variable as its type.
+ * \return true if the variable was written, false if id isn't a variable Id or
+ * the value is out of the domain of the variable and rejected by its policy.
+ */
+bool dd_write(variable_id_t id, const void *buf);
+
+/**
+ * \brief Reads the variables of the application data of an instance whose Id is
+ * between first and last, in Id order.
+ * \param[in] ctx Application data of the instance.
+ * \param[in] first Id of the first variable.
+ * \param[in] last Id of the last variable.
+ * \param[out] buf Buffer receiving the value of each variable as its type,
+ * without padding. Reading every variable needs VARIABLE_INFOS_SIZE bytes.
+ * \return The number of bytes written into buf.
+ */
+size_t dd_copy_range_ctx(const struct application_t *ctx, variable_id_t first,
+                         variable_id_t last, uint8_t *buf);
+
+/**
+ * \brief Reads the variables of the application data whose Id is between first
+ * and last, in Id order.
+ * \param[in] first Id of the first variable.
+ * \param[in] last Id of the last variable.
+ * \param[out] buf Buffer receiving the value of each variable as its type,
+ * without padding. Reading every variable needs VARIABLE_INFOS_SIZE bytes.
+ * \return The number of bytes written into buf.
+ */
+size_t dd_copy_range(variable_id_t first, variable_id_t last, uint8_t *buf);
+
+/**
+ * \brief Maps a snapshot file in memory, creating it if needed. A file written
+ * by another layout of the application data is reset.
+ * \param[in] path Path of the snapshot file.
+ * \return The mapped snapshot, or NULL on failure (errno is set).
+ */
+struct application_snapshot_t *application_snapshot_open(const char *path);
+
+/**
+ * \brief Restores the application data of an instance from the newest valid
+ * slot of a snapshot.
+ * \param[in] snapshot Snapshot mapped by application_snapshot_open().
+ * \param[out] ctx Application data of the instance.
+ * \return true if the application data was restored, false if the snapshot
+ * holds no valid slot, in which case the application data is left untouched.
+ */
+bool application_snapshot_restore_ctx(
+    const struct application_snapshot_t *snapshot, struct application_t *ctx);
+
+/**
+ * \brief Restores the application data from the newest valid slot of a
+ * snapshot.
+ * \param[in] snapshot Snapshot mapped by application_snapshot_open().
+ * \return true if the application data was restored, false if the snapshot
+ * holds no valid slot, in which case the application data is left untouched.
+ */
+bool
+application_snapshot_restore(const struct application_snapshot_t *snapshot);
+
+/**
+ * \brief Saves the application data of an instance into a snapshot. Only memory
+ * is written, the kernel writes the mapped file back on its own, so this is
+ * cheap enough to be called every cycle.
+ * \param[in,out] snapshot Snapshot mapped by application_snapshot_open().
+ * \param[in] ctx Application data of the instance.
+ */
+void application_snapshot_save_ctx(struct application_snapshot_t *snapshot,
+                                   const struct application_t *ctx);
+
+/**
+ * \brief Saves the application data into a snapshot. Only memory is written,
+ * the kernel writes the mapped file back on its own, so this is cheap enough to
+ * be called every cycle.
+ * \param[in,out] snapshot Snapshot mapped by application_snapshot_open().
+ */
+void application_snapshot_save(struct application_snapshot_t *snapshot);
+
+/**
+ * \brief Writes a snapshot back to its file and unmaps it.
+ * \param[in] snapshot Snapshot mapped by application_snapshot_open().
+ */
+void application_snapshot_close(struct application_snapshot_t *snapshot);
+
+/**
+ * \brief Publishes the application data of an instance for the readers of other
+ * threads. Never waits for the readers.
+ * \param[in,out] publication Publication written by this thread only.
+ * \param[in] ctx Application data of the instance.
+ */
+void application_publish_ctx(struct application_publication_t *publication,
+                             const struct application_t *ctx);
+
+/**
+ * \brief Publishes the application data for the readers of other threads. Never
+ * waits for the readers.
+ * \param[in,out] publication Publication written by this thread only.
+ */
+void application_publish(struct application_publication_t *publication);
+
+/**
+ * \brief Copies the last published application data, from any thread. The copy
+ * is consistent: it holds the application data of a single publication.
+ * \param[in] publication Publication to read.
+ * \param[out] copy Application data receiving the copy.
+ * \return Sequence number of the copied publication, 0 if nothing was published
+ * yet.
+ */
+uint64_t application_read_published(
+    const struct application_publication_t *publication,
+    struct application_t *copy);
+
+/**
+ * \brief Alignment of the fleet store arrays, in bytes.
+ */
+#define FLEET_ALIGNMENT 64
+
+/**
+ * \brief Application data of a fleet of vehicles, stored as one array per
+ * variable. Vehicle i of the fleet is made of the i-th element of each array.
+ * The arrays hold capacity elements, size rounded up to a multiple of
+ * FLEET_ALIGNMENT, and are aligned on FLEET_ALIGNMENT bytes. Unlike
+ * application_t, the arrays are directly accessed, so the values written into
+ * them must be in the domain of their type.
+ */
+struct fleet_t {
+  size_t size;
+  size_t capacity;
+  uint8_t *warnings_in;
+  uint8_t *sidelights_in;
+  uint8_t *sidelights_out;
+  uint8_t *sidelights_acknowledgement;
+  uint8_t *headlights_in;
+  uint8_t *headlights_out;
+  uint8_t *headlights_acknowledgement;
+  uint8_t *redlights_in;
+  uint8_t *redlights_out;
+  uint8_t *redlights_acknowledgement;
+  uint8_t *left_blinker_in;
+  uint8_t *left_blinker_out;
+  uint8_t *left_blinker_acknowledgement;
+  uint8_t *right_blinker_in;
+  uint8_t *right_blinker_out;
+  uint8_t *right_blinker_acknowledgement;
+  uint8_t *wipers_in;
+  uint8_t *wipers_out;
+  uint8_t *washer_fluid_in;
+  uint8_t *washer_fluid_out;
+  crc_8_t *commodos_crc_8;
+  mux_id_t *mux_frame_id;
+  frame_mileage_t *frame_mileage;
+  frame_speed_t *frame_speed;
+  frame_flags_t *frame_flags;
+  motor_flags_t *motor_flags;
+  tank_level_t *tank_level;
+  uint16_t *motor_speed;
+  battery_flags_t *battery_flags_in;
+  uint8_t *indicator_sidelights;
+  uint8_t *indicator_headlights;
+  uint8_t *indicator_redlights;
+  uint8_t *indicator_low_fuel;
+  uint8_t *indicator_motor_failure;
+  uint8_t *indicator_tire_pressure;
+  uint8_t *indicator_pads_failure;
+  uint8_t *indicator_battery_low;
+  uint8_t *indicator_warnings;
+  uint8_t *indicator_battery_failure;
+  uint8_t *indicator_coolant_overheat;
+  uint8_t *indicator_motor_pressure;
+  uint8_t *indicator_oil_overheat;
+  uint8_t *indicator_brake_failure;
+  int8_t *fsm_sidelights;
+  fsm_timer_t *fsm_sidelights_timer;
+  int8_t *fsm_headlights;
+  fsm_timer_t *fsm_headlights_timer;
+  int8_t *fsm_redlights;
+  fsm_timer_t *fsm_redlights_timer;
+  int8_t *fsm_left_blinker;
+  fsm_timer_t *fsm_left_blinker_timer;
+  int8_t *fsm_right_blinker;
+  fsm_timer_t *fsm_right_blinker_timer;
+  int8_t *fsm_wipers;
+  fsm_timer_t *fsm_wipers_timer;
+};
+
+/**
+ * \brief Allocates the arrays of a fleet store and initializes the application
+ * data of every vehicle.
+ * \param[out] fleet Fleet store to initialize.
+ * \param[in] size Number of vehicles of the fleet.
+ * \return true on success, false if the arrays couldn't be allocated.
+ */
+bool fleet_init(struct fleet_t *fleet, size_t size);
+
+/**
+ * \brief Releases the arrays of a fleet store.
+ * \param[in,out] fleet Fleet store initialized with fleet_init().
+ */
+void fleet_free(struct fleet_t *fleet);
+
+/**
+ * \brief Copies the application data of a vehicle of a fleet into an instance,
+ * through its setters.
+ * \param[in] fleet Fleet store.
+ * \param[in] index Index of the vehicle in the fleet.
+ * \param[in,out] ctx Application data of the instance.
+ */
+void fleet_load_ctx(const struct fleet_t *fleet, size_t index,
+                    struct application_t *ctx);
+
+/**
+ * \brief Copies the application data of an instance into a vehicle of a fleet.
+ * \param[in,out] fleet Fleet store.
+ * \param[in] index Index of the vehicle in the fleet.
+ * \param[in] ctx Application data of the instance.
+ */
+void fleet_store_ctx(struct fleet_t *fleet, size_t index,
+                     const struct application_t *ctx);
 #endif /* DATA_DICTIONARY_H */
\ No newline at end of file
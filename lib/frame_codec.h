@@ -0,0 +1,115 @@
+/*
+ * This file was automatically generated using csnake v0.3.5.
+ *
+ * This file should not be edited directly, any changes will be
+ * overwritten next time the script is run.
+ *
+ * Source code for csnake is available at:
+ * https://gitlab.com/andrejr/csnake
+ *
+ * csnake is also available on PyPI, at :
+ * https://pypi.org/project/csnake
+ */
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+#include "data_dictionary.h"
+#include <stdint.h>
+
+/**
+ * \brief Size of a mux_in frame, in bytes.
+ */
+#define FRAME_MUX_IN_SIZE 14
+
+/**
+ * \brief Size of a mux_out frame, in bytes.
+ */
+#define FRAME_MUX_OUT_SIZE 9
+
+/**
+ * \brief Size of a commodos_in frame, in bytes.
+ */
+#define FRAME_COMMODOS_IN_SIZE 2
+
+/**
+ * \brief Decodes a mux_in frame into the application data of an instance,
+ * through its setters.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] frame Frame of FRAME_MUX_IN_SIZE bytes.
+ */
+void decode_mux_in_frame_ctx(struct application_t *ctx, const uint8_t *frame);
+
+/**
+ * \brief Decodes a mux_in frame into the application data.
+ * \param[in] frame Frame of FRAME_MUX_IN_SIZE bytes.
+ */
+void decode_mux_in_frame(const uint8_t *frame);
+
+/**
+ * \brief Encodes the application data of an instance into a mux_in frame.
+ * \param[in] ctx Application data of the instance.
+ * \param[out] frame Frame of FRAME_MUX_IN_SIZE bytes.
+ */
+void encode_mux_in_frame_ctx(const struct application_t *ctx, uint8_t *frame);
+
+/**
+ * \brief Encodes the application data into a mux_in frame.
+ * \param[out] frame Frame of FRAME_MUX_IN_SIZE bytes.
+ */
+void encode_mux_in_frame(uint8_t *frame);
+
+/**
+ * \brief Decodes a mux_out frame into the application data of an instance,
+ * through its setters.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] frame Frame of FRAME_MUX_OUT_SIZE bytes.
+ */
+void decode_mux_out_frame_ctx(struct application_t *ctx, const uint8_t *frame);
+
+/**
+ * \brief Decodes a mux_out frame into the application data.
+ * \param[in] frame Frame of FRAME_MUX_OUT_SIZE bytes.
+ */
+void decode_mux_out_frame(const uint8_t *frame);
+
+/**
+ * \brief Encodes the application data of an instance into a mux_out frame.
+ * \param[in] ctx Application data of the instance.
+ * \param[out] frame Frame of FRAME_MUX_OUT_SIZE bytes.
+ */
+void encode_mux_out_frame_ctx(const struct application_t *ctx, uint8_t *frame);
+
+/**
+ * \brief Encodes the application data into a mux_out frame.
+ * \param[out] frame Frame of FRAME_MUX_OUT_SIZE bytes.
+ */
+void encode_mux_out_frame(uint8_t *frame);
+
+/**
+ * \brief Decodes a commodos_in frame into the application data of an instance,
+ * through its setters.
+ * \param[in,out] ctx Application data of the instance.
+ * \param[in] frame Frame of FRAME_COMMODOS_IN_SIZE bytes.
+ */
+void decode_commodos_in_frame_ctx(struct application_t *ctx,
+                                  const uint8_t *frame);
+
+/**
+ * \brief Decodes a commodos_in frame into the application data.
+ * \param[in] frame Frame of FRAME_COMMODOS_IN_SIZE bytes.
+ */
+void decode_commodos_in_frame(const uint8_t *frame);
+
+/**
+ * \brief Encodes the application data of an instance into a commodos_in frame.
+ * \param[in] ctx Application data of the instance.
+ * \param[out] frame Frame of FRAME_COMMODOS_IN_SIZE bytes.
+ */
+void encode_commodos_in_frame_ctx(const struct application_t *ctx,
+                                  uint8_t *frame);
+
+/**
+ * \brief Encodes the application data into a commodos_in frame.
+ * \param[out] frame Frame of FRAME_COMMODOS_IN_SIZE bytes.
+ */
+void encode_commodos_in_frame(uint8_t *frame);
+#endif /* FRAME_CODEC_H */
\ No newline at end of file
@@ -1,35 +1,336 @@
 # Don't mind the missing modules here, the virtual env takes care of that
+import argparse
 import csv
 import re
+import zlib
 import csnake as c
 
+parser = argparse.ArgumentParser(
+    description="Generates the data dictionary library from types.csv and variables.csv."
+)
+parser.add_argument(
+    "--inline", action="store_true",
+    help="generate the getters and setters as static inline functions in the header file "
+         "(the source file then only holds the application data and its initializer)"
+)
+parser.add_argument(
+    "--layout", choices=("plain", "packed"), default="plain",
+    help="memory layout of the application data: 'plain' stores each variable with its declared type, "
+         "'packed' stores the boolean signals as bits and narrows the types having a Storage in types.csv"
+)
+args = parser.parse_args()
+
+# In inline mode, the accessors are defined in the header so that they can be inlined at each call site
+accessor_qualifiers = "static inline" if args.inline else None
+
 types = dict()
 
+# Policies of the setters for the values out of the domain of their type: 'reject' keeps the current value, 'clamp'
+# writes the nearest bound of the domain and 'flag' writes the value anyway. The out of domain values are counted
+# whatever the policy.
+DOMAIN_POLICIES = ('reject', 'clamp', 'flag')
+
 with open('types.csv', newline='') as types_csv:
     for line in csv.DictReader(types_csv, delimiter=';', quotechar='"'):
+        if line['Domain'] and line['Policy'] not in DOMAIN_POLICIES:
+            raise SystemExit(f"Type {line['Name']} should have a Policy among {', '.join(DOMAIN_POLICIES)}")
+        if line['Policy'] == 'flag' and line['Storage'] not in ('', line['Declaration']):
+            raise SystemExit(f"Type {line['Name']} can't have the flag policy, its out of domain values don't fit "
+                             f"in its {line['Storage']} Storage")
         types[line['Name']] = line
 
 variables = list()
 
 with open('variables.csv', newline='') as variables_csv:
     for line in csv.DictReader(variables_csv, delimiter=';', quotechar='"'):
+        line['Id'] = int(line['Id'])
         variables.append(line)
 
+# The out of domain values written into each variable of a type having a Domain are counted in an array of counters
+domain_variables = [variable for variable in variables if types[variable['Type']]['Domain']]
+for index, variable in enumerate(domain_variables):
+    variable['Rejections'] = index
+
+# The variables changed during the current cycle are tracked in a bitmap indexed by variable Id
+CHANGES_WORD_BITS = 32
+changes_words = max(variable['Id'] for variable in variables) // CHANGES_WORD_BITS + 1
+
+# Compute the layout of the application data
+
+CACHE_LINE_SIZE = 64
+SIZES = {
+    'bool': 1,
+    'int8_t': 1, 'uint8_t': 1,
+    'int16_t': 2, 'uint16_t': 2,
+    'int32_t': 4, 'uint32_t': 4,
+    'int64_t': 8, 'uint64_t': 8,
+}
+
+
+def bit_word_type(bit_count):
+    """Returns the smallest unsigned type holding bit_count bits."""
+    return next(f"uint{width}_t" for width in (8, 16, 32, 64) if bit_count <= width)
+
+
+# Each field is a dict with keys Name, Declaration (C type of the field), Size (of one element) and Count (of
+# elements, for arrays)
+fields = [
+    {'Name': 'changes', 'Declaration': 'uint32_t', 'Size': SIZES['uint32_t'], 'Count': changes_words},
+]
+if domain_variables:
+    fields.append(
+        {'Name': 'rejections', 'Declaration': 'uint32_t', 'Size': SIZES['uint32_t'], 'Count': len(domain_variables)}
+    )
+
+if args.layout == 'packed':
+    # Boolean variables are packed as bits into one word per type (i.e. per direction: IN, OUT, indicators, acks)
+    bit_words = dict()
+    for variable in variables:
+        if types[variable['Type']]['Storage'] == 'bit':
+            word = bit_words.setdefault(variable['Type'], list())
+            variable['Word'] = "{}_bits".format(variable['Type'][:-2])
+            variable['Bit'] = len(word)
+            word.append(variable)
+
+    for type_name, word in bit_words.items():
+        declaration = bit_word_type(len(word))
+        fields.append(
+            {'Name': f"{type_name[:-2]}_bits", 'Declaration': declaration, 'Size': SIZES[declaration], 'Count': 1}
+        )
+
+    # Other variables are stored with their narrowed type, if any
+    for variable in variables:
+        if 'Word' not in variable:
+            declaration = types[variable['Type']]['Storage'] or types[variable['Type']]['Declaration']
+            if declaration != types[variable['Type']]['Declaration']:
+                variable['Storage'] = declaration
+            fields.append({'Name': variable['Name'], 'Declaration': declaration, 'Size': SIZES[declaration], 'Count': 1})
+
+    # Largest fields first, so that no padding is needed between fields
+    fields.sort(key=lambda field: field['Size'], reverse=True)
+else:
+    for variable in variables:
+        declaration = types[variable['Type']]['Declaration']
+        fields.append({'Name': variable['Name'], 'Declaration': declaration, 'Size': SIZES[declaration], 'Count': 1})
+
+offset = 0
+for field in fields:
+    offset += -offset % field['Size']  # Natural alignment of the field
+    field['Offset'] = offset
+    offset += field['Size'] * field['Count']
+
+struct_alignment = CACHE_LINE_SIZE if args.layout == 'packed' else max(field['Size'] for field in fields)
+struct_size = offset + (-offset % struct_alignment)
+
+if args.layout == 'packed' and offset > CACHE_LINE_SIZE:
+    raise SystemExit(f"Packed application data doesn't fit in a {CACHE_LINE_SIZE} bytes cache line ({offset} bytes)")
+
+with open('../data_dictionary.layout', 'w') as layout_report:
+    layout_report.write(f"Layout: {args.layout}\n")
+    layout_report.write(f"Size: {struct_size} bytes ({offset} bytes used, aligned on {struct_alignment} bytes)\n\n")
+    layout_report.write(f"{'Offset':>6} {'Size':>4}  {'Type':<9} Field\n")
+    for field in fields:
+        name = field['Name'] if field['Count'] == 1 else f"{field['Name']}[{field['Count']}]"
+        layout_report.write(f"{field['Offset']:>6} {field['Size'] * field['Count']:>4}  {field['Declaration']:<9} {name}\n")
+        if args.layout == 'packed' and field['Name'].endswith('_bits'):
+            for variable in bit_words[field['Name'][:-5] + '_t']:
+                layout_report.write(f"{'':>6} {'':>4}  {'':<9}   bit {variable['Bit']:>2}: {variable['Name']}\n")
+
+
+def read_expression(variable):
+    """Returns the C expression reading the variable from the application data pointed by ctx."""
+    if 'Word' in variable:
+        return "(ctx->{Word} >> {Bit}) & 1u".format(**variable)
+    if 'Storage' in variable:
+        return "({Type})ctx->{Name}".format(**variable)
+    return "ctx->{Name}".format(**variable)
+
+
+def write_statement(variable, value):
+    """Returns the C statement writing value into the variable of the application data pointed by ctx."""
+    if 'Word' in variable:
+        word_type = bit_word_type(len(bit_words[variable['Type']]))
+        return (
+            f"ctx->{variable['Word']} = ({word_type})((ctx->{variable['Word']} & "
+            f"~(({word_type})1 << {variable['Bit']})) | (({word_type})({value} ? 1 : 0) << {variable['Bit']}));"
+        )
+    if 'Storage' in variable:
+        return "ctx->{Name} = ({Storage}){value};".format(value=value, **variable)
+    return "ctx->{Name} = {value};".format(value=value, **variable)
+
+
+def mark_change_statement(variable, value):
+    """Returns the C statement flagging the variable as changed if value differs from its current value."""
+    word, bit = divmod(variable['Id'], CHANGES_WORD_BITS)
+    return f"ctx->changes[{word}] |= (uint32_t)(({read_expression(variable)}) != {value}) << {bit};"
+
+
+def context(const=False):
+    """Returns the context argument of the functions working on any instance of the application data."""
+    return c.Variable("ctx", "const struct application_t *" if const else "struct application_t *")
+
+
+def global_wrapper(function):
+    """Returns the function working on the global application data by calling function, which takes a context."""
+    wrapper = c.Function(
+        name=function.name[:-len("_ctx")],
+        return_type=function.return_type,
+        qualifiers=function.qualifiers,
+        arguments=[a for a in function.arguments if a.name != "ctx"]
+    )
+    call = "{}({})".format(
+        function.name, ", ".join("&application" if a.name == "ctx" else a.name for a in function.arguments)
+    )
+    wrapper.add_code(f"return {call};" if function.return_type != "void" else f"{call};")
+    return wrapper
+
+
+# Every generated function, with its documentation, in header order. Each context-taking function "x_ctx" is
+# followed by its global wrapper "x", working on the global application data.
+functions = list()
+
+
+def add_function(function, comment, ctx_comment):
+    """Adds a context-taking function and its global wrapper to the generated functions."""
+    functions.append((function, ctx_comment))
+    functions.append((global_wrapper(function), comment))
+
+
+# Generate init function (never inlined, as it is only called once)
+
+init = c.Function("application_init_ctx", arguments=[context()])
+for variable in variables:
+    init.add_code(write_statement(variable, variable['Default']))
+init.add_code(
+    [f"ctx->changes[{word}] = 0;" for word in range(changes_words)]
+    + [f"ctx->rejections[{index}] = 0;" for index in range(len(domain_variables))]
+)
+add_function(
+    init,
+    """
+    /**
+     * \\brief Initializer function for the application data.
+     */""",
+    """
+    /**
+     * \\brief Initializer function for an instance of the application data.
+     * \\param[out] ctx Application data to initialize.
+     */"""
+)
+
+# Generate change tracking functions
+
+changed = c.Function(
+    "application_changed_ctx",
+    return_type="bool",
+    qualifiers=accessor_qualifiers,
+    arguments=[context(const=True), c.Variable("id", "variable_id_t")]
+)
+changed.add_code(
+    f"return (ctx->changes[id / {CHANGES_WORD_BITS}] >> (id % {CHANGES_WORD_BITS})) & 1u;"
+)
+add_function(
+    changed,
+    """
+    /**
+     * \\brief Tells whether a variable changed value since the last call to application_clear_changes().
+     * \\param[in] id Id of the variable.
+     * \\return true if a setter changed the value of the variable, false otherwise.
+     */""",
+    """
+    /**
+     * \\brief Tells whether a variable changed value since the last call to application_clear_changes_ctx().
+     * \\param[in] ctx Application data of the instance.
+     * \\param[in] id Id of the variable.
+     * \\return true if a setter changed the value of the variable, false otherwise.
+     */"""
+)
+
+next_change = c.Function(
+    "application_next_change_ctx",
+    return_type="int32_t",
+    qualifiers=accessor_qualifiers,
+    arguments=[context(const=True), c.Variable("id", "int32_t")]
+)
+next_change.add_code((
+    f"for (int32_t word = (id + 1) / {CHANGES_WORD_BITS}; word < {changes_words}; word++) {{",
+    "uint32_t bits = ctx->changes[word];",
+    f"if (word == (id + 1) / {CHANGES_WORD_BITS}) {{",
+    f"bits &= UINT32_MAX << ((id + 1) % {CHANGES_WORD_BITS});",
+    "}",
+    "if (bits != 0) {",
+    f"return word * {CHANGES_WORD_BITS} + __builtin_ctz(bits);",
+    "}",
+    "}",
+    "return -1;"
+))
+add_function(
+    next_change,
+    """
+    /**
+     * \\brief Iterates over the variables changed since the last call to application_clear_changes().
+     * \\param[in] id Id of the previous changed variable, or -1 to get the first one.
+     * \\return Id of the next changed variable after id, or -1 if there is none.
+     */""",
+    """
+    /**
+     * \\brief Iterates over the variables changed since the last call to application_clear_changes_ctx().
+     * \\param[in] ctx Application data of the instance.
+     * \\param[in] id Id of the previous changed variable, or -1 to get the first one.
+     * \\return Id of the next changed variable after id, or -1 if there is none.
+     */"""
+)
+
+clear_changes = c.Function("application_clear_changes_ctx", qualifiers=accessor_qualifiers, arguments=[context()])
+clear_changes.add_code(
+    [f"ctx->changes[{word}] = 0;" for word in range(changes_words)]
+)
+add_function(
+    clear_changes,
+    """
+    /**
+     * \\brief Clears the set of changed variables, to be called at the start of each cycle.
+     */""",
+    """
+    /**
+     * \\brief Clears the set of changed variables of an instance, to be called at the start of each cycle.
+     * \\param[in,out] ctx Application data of the instance.
+     */"""
+)
+
 # Generate getters and setters
 
 for variable in variables:
-    variable['Getter'] = c.Function(
-        name="get_{Name}".format(**variable),
-        return_type=variable['Type']
+    getter = c.Function(
+        name="get_{Name}_ctx".format(**variable),
+        return_type=variable['Type'],
+        qualifiers=accessor_qualifiers,
+        arguments=[context(const=True)]
     )
-    variable['Getter'].add_code(
-        "return application.{Name};".format(**variable)
+    getter.add_code(
+        "return {};".format(read_expression(variable))
+    )
+    add_function(
+        getter,
+        """
+        /**
+         * \\brief Getter for application.{Name}.
+         * \\return {Comment}
+         */""".format(**variable),
+        """
+        /**
+         * \\brief Getter for ctx->{Name}.
+         * \\param[in] ctx Application data of the instance.
+         * \\return {Comment}
+         */""".format(**variable)
     )
 
-    variable['Setter'] = c.Function(
-        name="set_{Name}".format(**variable),
+    setter = c.Function(
+        name="set_{Name}_ctx".format(**variable),
         return_type="void",
+        qualifiers=accessor_qualifiers,
         arguments=[
+            context(),
             c.Variable("value", variable['Type'])
         ]
     )
@@ -38,24 +339,621 @@ for variable in variables:
     if domain:
 
         # Don't check zero lower bound if type is unsigned (gcc generates warning -Wtype-limits otherwise)
-        low_bound = f"value >= {domain.group(1)} &&" \
-            if types[variable['Type']]['Declaration'][0] != "u" or domain.group(1) != "0" \
-            else ""
-
-        variable['Setter'].add_code((
-            f"if ({low_bound} value <= {domain.group(2)}) {{",
-            "application.{Name} = value;".format(**variable),
-            "}"
+        check_low_bound = types[variable['Type']]['Declaration'][0] != "u" or domain.group(1) != "0"
+        below = f"(value < {domain.group(1)})"
+        above = f"(value > {domain.group(2)})"
+
+        # Out of domain values are handled without branches: the value is replaced using masks (all bits set when
+        # the condition is true, none otherwise)
+        setter.add_code((
+            f"uint32_t out_of_domain = {below + ' | ' if check_low_bound else ''}{above};",
+            f"ctx->rejections[{variable['Rejections']}] += out_of_domain;"
         ))
+        policy = types[variable['Type']]['Policy']
+        if policy == 'reject':
+            setter.add_code((
+                "// The current value is kept",
+                f"value ^= (value ^ {read_expression(variable)}) & -({variable['Type']})out_of_domain;"
+            ))
+        elif policy == 'clamp':
+            setter.add_code((
+                "// The value is replaced by the nearest bound of the domain",
+                *((f"value ^= (value ^ {domain.group(1)}) & -({variable['Type']}){below};",) if check_low_bound
+                  else ()),
+                f"value ^= (value ^ {domain.group(2)}) & -({variable['Type']}){above};"
+            ))
+        else:
+            setter.add_code("// The value is written anyway")
+    setter.add_code((
+        mark_change_statement(variable, "value"),
+        write_statement(variable, "value")
+    ))
+    add_function(
+        setter,
+        """
+        /**
+         * \\brief Setter for application.{Name}.
+         * \\param[in] value {Comment}
+         */""".format(**variable),
+        """
+        /**
+         * \\brief Setter for ctx->{Name}.
+         * \\param[in,out] ctx Application data of the instance.
+         * \\param[in] value {Comment}
+         */""".format(**variable)
+    )
+
+    if 'Rejections' in variable:
+        rejections = c.Function(
+            name="get_{Name}_rejections_ctx".format(**variable),
+            return_type="uint32_t",
+            qualifiers=accessor_qualifiers,
+            arguments=[context(const=True)]
+        )
+        rejections.add_code(f"return ctx->rejections[{variable['Rejections']}];")
+        add_function(
+            rejections,
+            """
+            /**
+             * \\brief Getter for the number of out of domain values written into application.{Name}.
+             * \\return Number of out of domain values, handled by the {Policy} policy of {Type}.
+             */""".format(**variable, Policy=types[variable['Type']]['Policy']),
+            """
+            /**
+             * \\brief Getter for the number of out of domain values written into ctx->{Name}.
+             * \\param[in] ctx Application data of the instance.
+             * \\return Number of out of domain values, handled by the {Policy} policy of {Type}.
+             */""".format(**variable, Policy=types[variable['Type']]['Policy'])
+        )
+
+# Generate the reflection table: the description of each variable, indexed by Id, and generic functions reading and
+# writing any variable through it as the raw bytes of its type
+
+variable_id_count = max(variable['Id'] for variable in variables) + 1
+fields_by_name = {field['Name']: field for field in fields}
+
+for variable in variables:
+    declaration = types[variable['Type']]['Declaration']
+    if declaration == 'bool':
+        minimum, maximum = 0, 1
+    elif declaration[0] == 'u':
+        minimum, maximum = 0, 2 ** (8 * SIZES[declaration]) - 1
     else:
-        variable['Setter'].add_code((
-            "application.{Name} = value;".format(**variable)
-        ))
+        minimum, maximum = -2 ** (8 * SIZES[declaration] - 1), 2 ** (8 * SIZES[declaration] - 1) - 1
+    domain = re.match(r"\[(\d+),\s?(\d+)]", types[variable['Type']]['Domain'])
+    if domain:
+        minimum, maximum = int(domain.group(1)), int(domain.group(2))
+    field = fields_by_name[variable.get('Word', variable['Name'])]
+    variable['Info'] = (
+        "[{Id}] = {{{Id}, \"{Name}\", \"{Type}\", ".format(**variable)
+        + f"{field['Offset']}, {SIZES[declaration]}, {field['Size']}, {variable.get('Bit', -1)}, "
+        + f"{'false' if declaration == 'bool' or declaration[0] == 'u' else 'true'}, "
+        + f"{minimum}, {maximum}, DOMAIN_POLICY_{(types[variable['Type']]['Policy'] or 'reject').upper()}, "
+        + f"{variable.get('Rejections', -1)}}},"
+    )
+
+struct_variable_info = [
+    "struct variable_info_t {",
+    "variable_id_t id;",
+    "const char *name;",
+    "const char *type;",
+    "uint16_t offset;",
+    "uint8_t size;",
+    "uint8_t storage_size;",
+    "int8_t bit;",
+    "bool is_signed;",
+    "int64_t min;",
+    "int64_t max;",
+    "domain_policy_t policy;",
+    "int8_t rejections;",
+    "};"
+]
+
+# Looks up the description of the variable, returning false from the function if id isn't a variable Id
+lookup_code = (
+    "if ((uint32_t)id >= VARIABLE_ID_COUNT || variable_infos[id].name == NULL) {",
+    "return false;",
+    "}",
+    "const struct variable_info_t *info = &variable_infos[id];"
+)
+
+dd_read = c.Function(
+    "dd_read_ctx",
+    return_type="bool",
+    arguments=[context(const=True), c.Variable("id", "variable_id_t"), c.Variable("buf", "void *")]
+)
+dd_read.add_code((
+    *lookup_code,
+    *(("memcpy(buf, (const uint8_t *)ctx + info->offset, info->size);",) if args.layout == 'plain' else (
+        "// Packed layout: the variable may be a bit or stored with a narrower type",
+        "int64_t value = load_value((const uint8_t *)ctx + info->offset, info->storage_size, info->is_signed);",
+        "if (info->bit >= 0) {",
+        "value = (value >> info->bit) & 1;",
+        "}",
+        "store_value(buf, info->size, value);"
+    )),
+    "return true;"
+))
+add_function(
+    dd_read,
+    """
+    /**
+     * \\brief Reads any variable of the application data.
+     * \\param[in] id Id of the variable.
+     * \\param[out] buf Buffer of variable_infos[id].size bytes, receiving the value of the variable as its type.
+     * \\return true if the variable was read, false if id isn't a variable Id.
+     */""",
+    """
+    /**
+     * \\brief Reads any variable of the application data of an instance.
+     * \\param[in] ctx Application data of the instance.
+     * \\param[in] id Id of the variable.
+     * \\param[out] buf Buffer of variable_infos[id].size bytes, receiving the value of the variable as its type.
+     * \\return true if the variable was read, false if id isn't a variable Id.
+     */"""
+)
+
+dd_write = c.Function(
+    "dd_write_ctx",
+    return_type="bool",
+    arguments=[context(), c.Variable("id", "variable_id_t"), c.Variable("buf", "const void *")]
+)
+dd_write.add_code((
+    *lookup_code,
+    "int64_t value = load_value(buf, info->size, info->is_signed);",
+    "bool out_of_domain = value < info->min || value > info->max;",
+    *((
+        "if (info->rejections >= 0) {",
+        "ctx->rejections[info->rejections] += out_of_domain;",
+        "}",
+    ) if domain_variables else ()),
+    "if (out_of_domain) {",
+    "if (info->policy == DOMAIN_POLICY_REJECT) {",
+    "return false;",
+    "}",
+    "if (info->policy == DOMAIN_POLICY_CLAMP) {",
+    "value = value < info->min ? info->min : info->max;",
+    "}",
+    "}",
+    "uint8_t *storage = (uint8_t *)ctx + info->offset;",
+    *((
+        "int64_t stored = load_value(storage, info->size, info->is_signed);",
+        "ctx->changes[id / 32] |= (uint32_t)(stored != value) << (id % 32);",
+        "store_value(storage, info->size, value);"
+    ) if args.layout == 'plain' else (
+        "// Packed layout: the variable may be a bit or stored with a narrower type",
+        "int64_t stored = load_value(storage, info->storage_size, info->is_signed);",
+        "if (info->bit >= 0) {",
+        "value = (stored & ~((int64_t)1 << info->bit)) | (value << info->bit);",
+        "}",
+        "ctx->changes[id / 32] |= (uint32_t)(stored != value) << (id % 32);",
+        "store_value(storage, info->storage_size, value);"
+    )),
+    "return true;"
+))
+add_function(
+    dd_write,
+    """
+    /**
+     * \\brief Writes any variable of the application data, as its setter does.
+     * \\param[in] id Id of the variable.
+     * \\param[in] buf Buffer of variable_infos[id].size bytes, holding the value of the variable as its type.
+     * \\return true if the variable was written, false if id isn't a variable Id or the value is out of the domain
+     * of the variable and rejected by its policy.
+     */""",
+    """
+    /**
+     * \\brief Writes any variable of the application data of an instance, as its setter does.
+     * \\param[in,out] ctx Application data of the instance.
+     * \\param[in] id Id of the variable.
+     * \\param[in] buf Buffer of variable_infos[id].size bytes, holding the value of the variable as its type.
+     * \\return true if the variable was written, false if id isn't a variable Id or the value is out of the domain
+     * of the variable and rejected by its policy.
+     */"""
+)
+
+dd_copy_range = c.Function(
+    "dd_copy_range_ctx",
+    return_type="size_t",
+    arguments=[
+        context(const=True),
+        c.Variable("first", "variable_id_t"),
+        c.Variable("last", "variable_id_t"),
+        c.Variable("buf", "uint8_t *")
+    ]
+)
+dd_copy_range.add_code((
+    "size_t size = 0;",
+    "for (uint32_t id = first; id <= (uint32_t)last && id < VARIABLE_ID_COUNT; id++) {",
+    "if (dd_read_ctx(ctx, (variable_id_t)id, &buf[size])) {",
+    "size += variable_infos[id].size;",
+    "}",
+    "}",
+    "return size;"
+))
+add_function(
+    dd_copy_range,
+    """
+    /**
+     * \\brief Reads the variables of the application data whose Id is between first and last, in Id order.
+     * \\param[in] first Id of the first variable.
+     * \\param[in] last Id of the last variable.
+     * \\param[out] buf Buffer receiving the value of each variable as its type, without padding. Reading every
+     * variable needs VARIABLE_INFOS_SIZE bytes.
+     * \\return The number of bytes written into buf.
+     */""",
+    """
+    /**
+     * \\brief Reads the variables of the application data of an instance whose Id is between first and last, in Id
+     * order.
+     * \\param[in] ctx Application data of the instance.
+     * \\param[in] first Id of the first variable.
+     * \\param[in] last Id of the last variable.
+     * \\param[out] buf Buffer receiving the value of each variable as its type, without padding. Reading every
+     * variable needs VARIABLE_INFOS_SIZE bytes.
+     * \\return The number of bytes written into buf.
+     */"""
+)
+
+# Generate the snapshot functions: the application data is saved every cycle into a memory-mapped file, so that it
+# can be restored on restart instead of being initialized. The file holds two slots written alternately, each with a
+# sequence number and a checksum, so that a save interrupted by a crash leaves the previous slot valid.
+
+SNAPSHOT_MAGIC = 0x56474342  # "BCGV" in little endian
+
+# Any change of the layout of application_t changes its version, invalidating the existing snapshot files
+snapshot_version = zlib.crc32(
+    ";".join(f"{field['Name']}:{field['Declaration']}:{field['Offset']}:{field['Count']}" for field in fields).encode()
+    + f";{args.layout};{struct_size}".encode()
+)
+
+snapshot_open = c.Function(
+    "application_snapshot_open",
+    return_type="struct application_snapshot_t *",
+    arguments=[c.Variable("path", "const char *")]
+)
+snapshot_open.add_code((
+    "int fd = open(path, O_RDWR | O_CREAT, 0644);",
+    "if (fd == -1) {",
+    "return NULL;",
+    "}",
+    "if (ftruncate(fd, sizeof(struct application_snapshot_t)) == -1) {",
+    "close(fd);",
+    "return NULL;",
+    "}",
+    "struct application_snapshot_t *snapshot = mmap(NULL, sizeof(struct application_snapshot_t), "
+    "PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);",
+    "close(fd); // The mapping stays valid once the file is closed",
+    "if (snapshot == MAP_FAILED) {",
+    "return NULL;",
+    "}",
+    "if (snapshot->magic != APPLICATION_SNAPSHOT_MAGIC || snapshot->version != APPLICATION_SNAPSHOT_VERSION ||",
+    "snapshot->size != sizeof(struct application_t)) {",
+    "// New file, or file written by another layout of the application data",
+    "memset(snapshot, 0, sizeof(struct application_snapshot_t));",
+    "snapshot->magic = APPLICATION_SNAPSHOT_MAGIC;",
+    "snapshot->version = APPLICATION_SNAPSHOT_VERSION;",
+    "snapshot->size = sizeof(struct application_t);",
+    "}",
+    "return snapshot;"
+))
+functions.append((
+    snapshot_open,
+    """
+    /**
+     * \\brief Maps a snapshot file in memory, creating it if needed. A file written by another layout of the
+     * application data is reset.
+     * \\param[in] path Path of the snapshot file.
+     * \\return The mapped snapshot, or NULL on failure (errno is set).
+     */"""
+))
+
+snapshot_restore = c.Function(
+    "application_snapshot_restore_ctx",
+    return_type="bool",
+    arguments=[c.Variable("snapshot", "const struct application_snapshot_t *"), context()]
+)
+snapshot_restore.add_code((
+    "const struct application_snapshot_slot_t *newest = NULL;",
+    "for (size_t i = 0; i < APPLICATION_SNAPSHOT_SLOTS; i++) {",
+    "const struct application_snapshot_slot_t *slot = &snapshot->slots[i];",
+    "uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);",
+    "if (sequence != 0 && (newest == NULL || sequence > newest->sequence) &&",
+    "slot->checksum == snapshot_checksum(&slot->data, sequence)) {",
+    "newest = slot;",
+    "}",
+    "}",
+    "if (newest == NULL) {",
+    "return false;",
+    "}",
+    "*ctx = newest->data;",
+    *(f"ctx->changes[{word}] = 0;" for word in range(changes_words)),
+    "return true;"
+))
+add_function(
+    snapshot_restore,
+    """
+    /**
+     * \\brief Restores the application data from the newest valid slot of a snapshot.
+     * \\param[in] snapshot Snapshot mapped by application_snapshot_open().
+     * \\return true if the application data was restored, false if the snapshot holds no valid slot, in which case
+     * the application data is left untouched.
+     */""",
+    """
+    /**
+     * \\brief Restores the application data of an instance from the newest valid slot of a snapshot.
+     * \\param[in] snapshot Snapshot mapped by application_snapshot_open().
+     * \\param[out] ctx Application data of the instance.
+     * \\return true if the application data was restored, false if the snapshot holds no valid slot, in which case
+     * the application data is left untouched.
+     */"""
+)
+
+snapshot_save = c.Function(
+    "application_snapshot_save_ctx",
+    arguments=[c.Variable("snapshot", "struct application_snapshot_t *"), context(const=True)]
+)
+snapshot_save.add_code((
+    "// Overwrite the oldest slot, the newest one stays valid until the sequence number is published",
+    "uint64_t sequence = snapshot->slots[0].sequence > snapshot->slots[1].sequence ? snapshot->slots[0].sequence",
+    ": snapshot->slots[1].sequence;",
+    "sequence++;",
+    "struct application_snapshot_slot_t *slot = &snapshot->slots[sequence % APPLICATION_SNAPSHOT_SLOTS];",
+    "__atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);",
+    "slot->data = *ctx;",
+    "slot->checksum = snapshot_checksum(&slot->data, sequence);",
+    "__atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);"
+))
+add_function(
+    snapshot_save,
+    """
+    /**
+     * \\brief Saves the application data into a snapshot. Only memory is written, the kernel writes the mapped file
+     * back on its own, so this is cheap enough to be called every cycle.
+     * \\param[in,out] snapshot Snapshot mapped by application_snapshot_open().
+     */""",
+    """
+    /**
+     * \\brief Saves the application data of an instance into a snapshot. Only memory is written, the kernel writes
+     * the mapped file back on its own, so this is cheap enough to be called every cycle.
+     * \\param[in,out] snapshot Snapshot mapped by application_snapshot_open().
+     * \\param[in] ctx Application data of the instance.
+     */"""
+)
+
+snapshot_close = c.Function(
+    "application_snapshot_close",
+    arguments=[c.Variable("snapshot", "struct application_snapshot_t *")]
+)
+snapshot_close.add_code((
+    "msync(snapshot, sizeof(struct application_snapshot_t), MS_SYNC);",
+    "munmap(snapshot, sizeof(struct application_snapshot_t));"
+))
+functions.append((
+    snapshot_close,
+    """
+    /**
+     * \\brief Writes a snapshot back to its file and unmaps it.
+     * \\param[in] snapshot Snapshot mapped by application_snapshot_open().
+     */"""
+))
+
+struct_snapshot_slot = [
+    "struct application_snapshot_slot_t {",
+    "uint64_t sequence;",
+    "uint32_t checksum;",
+    "uint32_t reserved;",
+    "struct application_t data;",
+    "};"
+]
+
+struct_snapshot = [
+    "struct application_snapshot_t {",
+    "uint32_t magic;",
+    "uint32_t version;",
+    "uint32_t size;",
+    "uint32_t reserved;",
+    "struct application_snapshot_slot_t slots[APPLICATION_SNAPSHOT_SLOTS];",
+    "};"
+]
+
+# Generate the publication functions: at the end of each cycle, the application data is copied into one of two slots
+# which readers on other threads copy in turn, without locks. The writer never waits for the readers, a reader whose
+# copy overlapped a publication detects it with the sequence number (seqlock) and copies again.
+
+publish = c.Function(
+    "application_publish_ctx",
+    arguments=[c.Variable("publication", "struct application_publication_t *"), context(const=True)]
+)
+publish.add_code((
+    "// Only the writer modifies the sequence number",
+    "uint64_t sequence = __atomic_load_n(&publication->sequence, __ATOMIC_RELAXED) + 1;",
+    "// Orders the previous publication before the writes into the slot, so that a reader of this slot copying them",
+    "// sees the sequence number change",
+    "__atomic_thread_fence(__ATOMIC_RELEASE);",
+    "publication->slots[sequence % APPLICATION_PUBLICATION_SLOTS] = *ctx;",
+    "__atomic_store_n(&publication->sequence, sequence, __ATOMIC_RELEASE);"
+))
+add_function(
+    publish,
+    """
+    /**
+     * \\brief Publishes the application data for the readers of other threads. Never waits for the readers.
+     * \\param[in,out] publication Publication written by this thread only.
+     */""",
+    """
+    /**
+     * \\brief Publishes the application data of an instance for the readers of other threads. Never waits for the
+     * readers.
+     * \\param[in,out] publication Publication written by this thread only.
+     * \\param[in] ctx Application data of the instance.
+     */"""
+)
+
+read_published = c.Function(
+    "application_read_published",
+    return_type="uint64_t",
+    arguments=[
+        c.Variable("publication", "const struct application_publication_t *"),
+        c.Variable("copy", "struct application_t *")
+    ]
+)
+read_published.add_code((
+    "uint64_t sequence;",
+    "do {",
+    "sequence = __atomic_load_n(&publication->sequence, __ATOMIC_ACQUIRE);",
+    "*copy = publication->slots[sequence % APPLICATION_PUBLICATION_SLOTS];",
+    "__atomic_thread_fence(__ATOMIC_ACQUIRE);",
+    "// The writer overwrites this slot only after publishing the next sequence number",
+    "} while (__atomic_load_n(&publication->sequence, __ATOMIC_RELAXED) != sequence);",
+    "return sequence;"
+))
+functions.append((
+    read_published,
+    """
+    /**
+     * \\brief Copies the last published application data, from any thread. The copy is consistent: it holds the
+     * application data of a single publication.
+     * \\param[in] publication Publication to read.
+     * \\param[out] copy Application data receiving the copy.
+     * \\return Sequence number of the copied publication, 0 if nothing was published yet.
+     */"""
+))
+
+struct_publication = [
+    f"struct __attribute__((aligned({CACHE_LINE_SIZE}))) application_publication_t {{",
+    "struct application_t slots[APPLICATION_PUBLICATION_SLOTS];",
+    f"uint64_t sequence __attribute__((aligned({CACHE_LINE_SIZE})));",
+    "};"
+]
+
+# Generate the fleet store: the application data of many vehicles, stored as one array per variable (structure of
+# arrays) so that batch functions can update every vehicle in a single vectorized pass. The arrays use one byte per
+# boolean signal and the narrowed types, whatever the layout of application_t, to fit as many vehicles as possible in
+# each vector register.
+
+FLEET_ALIGNMENT = CACHE_LINE_SIZE
 
-# Generate init function
-init = c.Function("application_init")
 for variable in variables:
-    init.add_code("application.{Name} = {Default};".format(**variable))
+    storage = types[variable['Type']]['Storage']
+    variable['Lane'] = 'uint8_t' if storage == 'bit' else storage or variable['Type']
+    variable['LaneSize'] = SIZES['uint8_t' if storage == 'bit' else storage or types[variable['Type']]['Declaration']]
+
+
+def fleet(const=False):
+    """Returns the fleet argument of the fleet store functions."""
+    return c.Variable("fleet", "const struct fleet_t *" if const else "struct fleet_t *")
+
+
+# Every generated fleet store function, with its documentation, in header order
+fleet_functions = list()
+
+fleet_init = c.Function(
+    "fleet_init",
+    return_type="bool",
+    arguments=[fleet(), c.Variable("size", "size_t")]
+)
+fleet_init.add_code((
+    "size_t capacity = (size + FLEET_ALIGNMENT - 1) / FLEET_ALIGNMENT * FLEET_ALIGNMENT;",
+    "uint8_t *data = aligned_alloc(FLEET_ALIGNMENT, capacity * {});".format(
+        sum(variable['LaneSize'] for variable in variables)
+    ),
+    "if (data == NULL) {",
+    "return false;",
+    "}",
+    "fleet->size = size;",
+    "fleet->capacity = capacity;",
+    # Every array size is a multiple of FLEET_ALIGNMENT, so the arrays carved one after the other stay aligned
+    *(statement for variable in variables for statement in (
+        f"fleet->{variable['Name']} = ({variable['Lane']} *)data;",
+        f"data += capacity * sizeof(*fleet->{variable['Name']});"
+    )),
+    "for (size_t i = 0; i < capacity; i++) {",
+    *(f"fleet->{variable['Name']}[i] = ({variable['Lane']}){variable['Default']};" for variable in variables),
+    "}",
+    "return true;"
+))
+fleet_functions.append((
+    fleet_init,
+    """
+    /**
+     * \\brief Allocates the arrays of a fleet store and initializes the application data of every vehicle.
+     * \\param[out] fleet Fleet store to initialize.
+     * \\param[in] size Number of vehicles of the fleet.
+     * \\return true on success, false if the arrays couldn't be allocated.
+     */"""
+))
+
+fleet_free = c.Function("fleet_free", arguments=[fleet()])
+fleet_free.add_code((
+    # All the arrays share the allocation starting with the first one
+    f"free(fleet->{variables[0]['Name']});",
+    "*fleet = (struct fleet_t){0};"
+))
+fleet_functions.append((
+    fleet_free,
+    """
+    /**
+     * \\brief Releases the arrays of a fleet store.
+     * \\param[in,out] fleet Fleet store initialized with fleet_init().
+     */"""
+))
+
+fleet_load = c.Function(
+    "fleet_load_ctx",
+    arguments=[fleet(const=True), c.Variable("index", "size_t"), context()]
+)
+fleet_load.add_code(
+    [f"set_{variable['Name']}_ctx(ctx, ({variable['Type']})fleet->{variable['Name']}[index]);"
+     for variable in variables]
+)
+fleet_functions.append((
+    fleet_load,
+    """
+    /**
+     * \\brief Copies the application data of a vehicle of a fleet into an instance, through its setters.
+     * \\param[in] fleet Fleet store.
+     * \\param[in] index Index of the vehicle in the fleet.
+     * \\param[in,out] ctx Application data of the instance.
+     */"""
+))
+
+fleet_store = c.Function(
+    "fleet_store_ctx",
+    arguments=[fleet(), c.Variable("index", "size_t"), context(const=True)]
+)
+fleet_store.add_code(
+    [f"fleet->{variable['Name']}[index] = ({variable['Lane']})get_{variable['Name']}_ctx(ctx);"
+     for variable in variables]
+)
+fleet_functions.append((
+    fleet_store,
+    """
+    /**
+     * \\brief Copies the application data of an instance into a vehicle of a fleet.
+     * \\param[in,out] fleet Fleet store.
+     * \\param[in] index Index of the vehicle in the fleet.
+     * \\param[in] ctx Application data of the instance.
+     */"""
+))
+
+struct_fleet = [
+    "struct fleet_t {",
+    "size_t size;",
+    "size_t capacity;",
+    *("{Lane} *{Name};".format(**variable) for variable in variables),
+    "};"
+]
+
+# Generate application data structure (csnake doesn't support attributes, so it is written manually)
+
+struct_application = [
+    "struct __attribute__((aligned({}))) application_t {{".format(struct_alignment)
+    if args.layout == 'packed' else "struct application_t {",
+    *("{Declaration} {Name};".format(**field) if field['Count'] == 1
+      else "{Declaration} {Name}[{Count}];".format(**field) for field in fields),
+    "};"
+]
 
 # Generate header file
 
@@ -66,6 +964,7 @@ header_file.start_if_def("DATA_DICTIONARY_H", invert=True)
 header_file.add_define("DATA_DICTIONARY_H")
 
 header_file.include("<stdbool.h>")
+header_file.include("<stddef.h>")
 header_file.include("<stdint.h>")
 
 for typedef in types.values():
@@ -94,32 +993,173 @@ for typedef in types.values():
         )
         header_file.add_enum(typedef_enum)
 
+variable_ids = c.Enum(
+    name="variable_id_t",
+    typedef=True,
+    prefix="VARIABLE_ID_"
+)
+for variable in sorted(variables, key=lambda v: v['Id']):
+    variable_ids.add_value(variable['Name'].upper(), variable['Id'])
 header_file.add_lines(
     """
     /**
-     * \\brief Initializer function for the application data.
+     * \\brief Ids of the application variables, as defined in variables.csv.
      */"""
 )
-header_file.add_function_prototype(init)
+header_file.add_enum(variable_ids)
 
-for variable in variables:
-    header_file.add_lines(
-        """
-        /**
-         * \\brief Getter for application.{Name}.
-         * \\return {Comment}
-         */""".format(**variable)
-    )
-    header_file.add_function_prototype(variable['Getter'])
+header_file.add_lines(
+    """
+    /**
+     * \\brief Number of entries of variable_infos, i.e. highest variable Id + 1.
+     */"""
+)
+header_file.add_define("VARIABLE_ID_COUNT", variable_id_count)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Total size of the values of the variables, as written by dd_copy_range().
+     */"""
+)
+header_file.add_define(
+    "VARIABLE_INFOS_SIZE", sum(SIZES[types[variable['Type']]['Declaration']] for variable in variables)
+)
+domain_policies = c.Enum(
+    name="domain_policy_t",
+    typedef=True,
+    prefix="DOMAIN_POLICY_"
+)
+domain_policies.add_values([policy.upper() for policy in DOMAIN_POLICIES])
+header_file.add_lines(
+    """
+    /**
+     * \\brief Policies of the setters for the values out of the domain of their type, as defined in types.csv.
+     */"""
+)
+header_file.add_enum(domain_policies)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Description of a variable of the application data: its Id, name and type as defined in
+     * variables.csv, the offset of its storage in application_t, the size of its type and storage, its bit in the
+     * storage word (-1 if it isn't stored as a bit), the signedness of its type, its domain with the policy of its
+     * setter and the index of its counter of out of domain values in application_t (-1 if it has none).
+     */"""
+)
+header_file.add_lines(struct_variable_info)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Description of each variable, indexed by Id. Unused Ids have a NULL name.
+     */"""
+)
+header_file.add_variable_declaration(
+    c.Variable("variable_infos", "const struct variable_info_t", array="VARIABLE_ID_COUNT"),
+    extern=True
+)
 
-    header_file.add_lines(
-        """
-        /**
-         * \\brief Setter for application.{Name}.
-         * \\param[in] value {Comment}
-         */""".format(**variable)
-    )
-    header_file.add_function_prototype(variable['Setter'])
+header_file.add_lines(
+    """
+    /**
+     * \\brief Application data, only meant to be accessed through the getters and setters below. Any number of
+     * instances can be created and handled with the *_ctx functions.
+     */"""
+)
+header_file.add_lines(struct_application)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Global instance of the application data, used by the functions without context.
+     */"""
+)
+header_file.add_variable_declaration(
+    c.Variable("application", "struct application_t"),
+    extern=True
+)
+
+header_file.add_lines(
+    """
+    /**
+     * \\brief Magic number of the snapshot files.
+     */"""
+)
+header_file.add_define("APPLICATION_SNAPSHOT_MAGIC", f"0x{SNAPSHOT_MAGIC:08x}u")
+header_file.add_lines(
+    """
+    /**
+     * \\brief Version of the snapshot files, derived from the layout of application_t.
+     */"""
+)
+header_file.add_define("APPLICATION_SNAPSHOT_VERSION", f"0x{snapshot_version:08x}u")
+header_file.add_lines(
+    """
+    /**
+     * \\brief Number of slots of a snapshot, written alternately.
+     */"""
+)
+header_file.add_define("APPLICATION_SNAPSHOT_SLOTS", 2)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Copy of the application data held by a snapshot. The slot is valid if its sequence number isn't 0
+     * and its checksum matches its data and sequence number.
+     */"""
+)
+header_file.add_lines(struct_snapshot_slot)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Snapshot of the application data, as mapped from its file. The valid slot with the highest sequence
+     * number holds the last saved application data.
+     */"""
+)
+header_file.add_lines(struct_snapshot)
+
+header_file.add_lines(
+    """
+    /**
+     * \\brief Number of slots of a publication, written alternately.
+     */"""
+)
+header_file.add_define("APPLICATION_PUBLICATION_SLOTS", 2)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Application data published by a thread for the readers of other threads. The slot of the last
+     * publication is given by its sequence number. The sequence number is on its own cache line, so that the writes
+     * into a slot don't invalidate the sequence number polled by the readers.
+     */"""
+)
+header_file.add_lines(struct_publication)
+
+for function, comment in functions:
+    header_file.add_lines(comment)
+    if function.qualifiers:
+        header_file.add_function_definition(function)
+    else:
+        header_file.add_function_prototype(function)
+
+header_file.add_lines(
+    """
+    /**
+     * \\brief Alignment of the fleet store arrays, in bytes.
+     */"""
+)
+header_file.add_define("FLEET_ALIGNMENT", FLEET_ALIGNMENT)
+header_file.add_lines(
+    """
+    /**
+     * \\brief Application data of a fleet of vehicles, stored as one array per variable. Vehicle i of the fleet
+     * is made of the i-th element of each array. The arrays hold capacity elements, size rounded up to a multiple
+     * of FLEET_ALIGNMENT, and are aligned on FLEET_ALIGNMENT bytes. Unlike application_t, the arrays are directly
+     * accessed, so the values written into them must be in the domain of their type.
+     */"""
+)
+header_file.add_lines(struct_fleet)
+
+for function, comment in fleet_functions:
+    header_file.add_lines(comment)
+    header_file.add_function_prototype(function)
 
 header_file.end_if_def()
 header_file.write_to_file("../data_dictionary.h")
@@ -127,23 +1167,296 @@ header_file.write_to_file("../data_dictionary.h")
 # Generate source file
 
 source_file = c.CodeWriter()
+source_file.include("<fcntl.h>")
+source_file.include("<stddef.h>")
+source_file.include("<stdlib.h>")
+source_file.include("<string.h>")
+source_file.include("<sys/mman.h>")
+source_file.include("<unistd.h>")
 source_file.include('"data_dictionary.h"')
 
-struct_application = c.Struct("application_t")
-
-for variable in variables:
-    struct_application.add_variable(c.Variable(variable['Name'], variable['Type']))
-
-source_file.add_struct(struct_application)
+# Check that the compiler agrees with the generated layout report
+source_file.add_lines(
+    "_Static_assert(sizeof(struct application_t) == {0}, \"application_t should be {0} bytes\");".format(struct_size)
+)
+for field in fields:
+    source_file.add_lines(
+        "_Static_assert(offsetof(struct application_t, {Name}) == {Offset}, "
+        "\"{Name} should be at offset {Offset}\");".format(**field)
+    )
 
 source_file.add_variable_declaration(
     c.Variable("application", "struct application_t")
 )
 
-for variable in variables:
-    source_file.add_function_definition(variable['Getter'])
-    source_file.add_function_definition(variable['Setter'])
+source_file.add_lines("const struct variable_info_t variable_infos[VARIABLE_ID_COUNT] = {")
+source_file.add_lines([variable['Info'] for variable in sorted(variables, key=lambda v: v['Id'])])
+source_file.add_lines("};")
+
+# Values are loaded and stored as 64 bits integers by the reflection functions, whatever the size of their type
+load_value = c.Function(
+    "load_value",
+    return_type="int64_t",
+    qualifiers=["static"],
+    arguments=[c.Variable("buf", "const void *"), c.Variable("size", "uint8_t"), c.Variable("is_signed", "bool")]
+)
+store_value = c.Function(
+    "store_value",
+    qualifiers=["static"],
+    arguments=[c.Variable("buf", "void *"), c.Variable("size", "uint8_t"), c.Variable("value", "int64_t")]
+)
+load_value.add_code("switch (size) {")
+store_value.add_code("switch (size) {")
+for size in (1, 2, 4):
+    load_value.add_code((
+        f"case {size}: {{",
+        f"uint{8 * size}_t value;",
+        "memcpy(&value, buf, sizeof(value));",
+        f"return is_signed ? (int64_t)(int{8 * size}_t)value : (int64_t)value;",
+        "}"
+    ))
+    store_value.add_code((
+        f"case {size}: {{",
+        f"uint{8 * size}_t truncated = (uint{8 * size}_t)value;",
+        "memcpy(buf, &truncated, sizeof(truncated));",
+        "break;",
+        "}"
+    ))
+load_value.add_code((
+    "default: {",
+    "int64_t value;",
+    "memcpy(&value, buf, sizeof(value));",
+    "return value;",
+    "}",
+    "}"
+))
+store_value.add_code((
+    "default:",
+    "memcpy(buf, &value, sizeof(value));",
+    "}"
+))
+source_file.add_function_definition(load_value)
+source_file.add_function_definition(store_value)
+
+# FNV-1a hash of the application data and sequence number of a snapshot slot
+snapshot_checksum = c.Function(
+    "snapshot_checksum",
+    return_type="uint32_t",
+    qualifiers=["static"],
+    arguments=[c.Variable("data", "const struct application_t *"), c.Variable("sequence", "uint64_t")]
+)
+snapshot_checksum.add_code((
+    "const uint8_t *bytes = (const uint8_t *)data;",
+    "uint32_t hash = 2166136261u;",
+    "for (size_t i = 0; i < sizeof(struct application_t); i++) {",
+    "hash = (hash ^ bytes[i]) * 16777619u;",
+    "}",
+    "for (size_t i = 0; i < sizeof(sequence); i++) {",
+    "hash = (hash ^ (uint8_t)(sequence >> (8 * i))) * 16777619u;",
+    "}",
+    "return hash;"
+))
+source_file.add_function_definition(snapshot_checksum)
 
-source_file.add_function_definition(init)
+for function, _ in functions:
+    if not function.qualifiers:
+        source_file.add_function_definition(function)
+
+for function, _ in fleet_functions:
+    source_file.add_function_definition(function)
 
 source_file.write_to_file("../data_dictionary.c")
+
+# Generate the frame codec: decode and encode functions for each frame of frames.csv, moving every field between its
+# bytes in the frame and its variable in the application data
+
+variables_by_name = {variable['Name']: variable for variable in variables}
+
+frames = dict()
+
+with open('frames.csv', newline='') as frames_csv:
+    for line in csv.DictReader(frames_csv, delimiter=';', quotechar='"'):
+        for column in ('Byte', 'Bit', 'Width'):
+            line[column] = int(line[column])
+        if line['Variable'] not in variables_by_name:
+            raise SystemExit(f"Unknown variable {line['Variable']} in frame {line['Frame']}")
+        if line['Width'] > 8 and (line['Width'] not in (16, 32, 64) or line['Bit'] != 0
+                                  or line['Endianness'] not in ('big', 'little')):
+            raise SystemExit(f"Field {line['Variable']} of frame {line['Frame']} should be 16, 32 or 64 bits wide, "
+                             "start on a byte boundary and have a big or little endianness")
+        if line['Width'] <= 8 and line['Bit'] + line['Width'] > 8:
+            raise SystemExit(f"Field {line['Variable']} of frame {line['Frame']} shouldn't cross a byte boundary")
+        frames.setdefault(line['Frame'], list()).append(line)
+
+
+def frame_size(fields):
+    """Returns the size in bytes of a frame, i.e. the end of its last field."""
+    return max(field['Byte'] + max(field['Width'] // 8, 1) for field in fields)
+
+
+def frame_size_macro(frame):
+    return f"FRAME_{frame.upper()}_SIZE"
+
+
+def load_expression(field):
+    """Returns the C expression reading the raw value of a field from frame."""
+    if field['Width'] > 8:
+        return "load_{}{}(frame + {})".format('be' if field['Endianness'] == 'big' else 'le', field['Width'],
+                                              field['Byte'])
+    if field['Width'] == 8:
+        return f"frame[{field['Byte']}]"
+    if field['Bit'] == 0:
+        return f"frame[{field['Byte']}] & 0x{(1 << field['Width']) - 1:x}u"
+    return f"(frame[{field['Byte']}] >> {field['Bit']}) & 0x{(1 << field['Width']) - 1:x}u"
+
+
+def store_term(field):
+    """Returns the C expression of the bits of a byte wide, or narrower, field in its frame byte."""
+    if field['Width'] == 8:
+        return f"get_{field['Variable']}_ctx(ctx)"
+    term = f"get_{field['Variable']}_ctx(ctx) & 0x{(1 << field['Width']) - 1:x}u"
+    return f"(({term}) << {field['Bit']})" if field['Bit'] != 0 else f"({term})"
+
+
+codec_functions = list()
+
+for frame, fields in frames.items():
+    decode = c.Function(
+        f"decode_{frame}_frame_ctx",
+        arguments=[context(), c.Variable("frame", "const uint8_t *")]
+    )
+    decode.add_code(
+        [f"set_{field['Variable']}_ctx(ctx, ({variables_by_name[field['Variable']]['Type']})"
+         + (f"({load_expression(field)}));" if field['Width'] < 8 else f"{load_expression(field)});")
+         for field in fields]
+    )
+    codec_functions.append((decode, f"""
+    /**
+     * \\brief Decodes a {frame} frame into the application data.
+     * \\param[in] frame Frame of {frame_size_macro(frame)} bytes.
+     */""", f"""
+    /**
+     * \\brief Decodes a {frame} frame into the application data of an instance, through its setters.
+     * \\param[in,out] ctx Application data of the instance.
+     * \\param[in] frame Frame of {frame_size_macro(frame)} bytes.
+     */"""))
+
+    encode = c.Function(
+        f"encode_{frame}_frame_ctx",
+        arguments=[context(const=True), c.Variable("frame", "uint8_t *")]
+    )
+    # Fields sharing a byte are merged into a single store, bytes without any field are cleared
+    byte_fields = dict()
+    for field in fields:
+        if field['Width'] > 8:
+            encode.add_code("store_{}{}(frame + {}, (uint{}_t)get_{}_ctx(ctx));".format(
+                'be' if field['Endianness'] == 'big' else 'le', field['Width'], field['Byte'], field['Width'],
+                field['Variable']
+            ))
+            for byte in range(field['Byte'], field['Byte'] + field['Width'] // 8):
+                byte_fields[byte] = None
+        else:
+            byte_fields.setdefault(field['Byte'], list()).append(field)
+    for byte in range(frame_size(fields)):
+        if byte not in byte_fields:
+            encode.add_code(f"frame[{byte}] = 0;")
+        elif byte_fields[byte] is not None:
+            terms = [store_term(field) for field in byte_fields[byte]]
+            encode.add_code("frame[{}] = (uint8_t){};".format(
+                byte, terms[0] if len(terms) == 1 else "({})".format(" | ".join(terms))
+            ))
+    codec_functions.append((encode, f"""
+    /**
+     * \\brief Encodes the application data into a {frame} frame.
+     * \\param[out] frame Frame of {frame_size_macro(frame)} bytes.
+     */""", f"""
+    /**
+     * \\brief Encodes the application data of an instance into a {frame} frame.
+     * \\param[in] ctx Application data of the instance.
+     * \\param[out] frame Frame of {frame_size_macro(frame)} bytes.
+     */"""))
+
+# Generate frame codec header file
+
+codec_header_file = c.CodeWriter()
+codec_header_file.add_autogen_comment()
+
+codec_header_file.start_if_def("FRAME_CODEC_H", invert=True)
+codec_header_file.add_define("FRAME_CODEC_H")
+
+codec_header_file.include('"data_dictionary.h"')
+codec_header_file.include("<stdint.h>")
+
+for frame, fields in frames.items():
+    codec_header_file.add_lines(
+        f"""
+        /**
+         * \\brief Size of a {frame} frame, in bytes.
+         */"""
+    )
+    codec_header_file.add_define(frame_size_macro(frame), frame_size(fields))
+
+for function, comment, ctx_comment in codec_functions:
+    codec_header_file.add_lines(ctx_comment)
+    codec_header_file.add_function_prototype(function)
+    codec_header_file.add_lines(comment)
+    codec_header_file.add_function_prototype(global_wrapper(function))
+
+codec_header_file.end_if_def()
+codec_header_file.write_to_file("../frame_codec.h")
+
+# Generate frame codec source file
+
+codec_source_file = c.CodeWriter()
+codec_source_file.include("<string.h>")
+codec_source_file.include('"frame_codec.h"')
+
+# Unaligned loads and stores of the multi-byte fields, swapping bytes when the endianness differs from the host one
+accesses = sorted({(field['Endianness'], field['Width']) for fields in frames.values() for field in fields
+                   if field['Width'] > 8})
+for endianness, width in accesses:
+    swap = "__ORDER_LITTLE_ENDIAN__" if endianness == 'big' else "__ORDER_BIG_ENDIAN__"
+    suffix = f"{'be' if endianness == 'big' else 'le'}{width}"
+
+    load = c.Function(
+        f"load_{suffix}",
+        return_type=f"uint{width}_t",
+        qualifiers="static inline",
+        arguments=[c.Variable("bytes", "const uint8_t *")]
+    )
+    load.add_code((
+        f"uint{width}_t value;",
+        "memcpy(&value, bytes, sizeof(value));",
+        f"#if __BYTE_ORDER__ == {swap}",
+        f"value = __builtin_bswap{width}(value);",
+        "#endif",
+        "return value;"
+    ))
+    codec_source_file.add_lines(f"""
+        /**
+         * \\brief Loads a {width}-bit {endianness} endian value from unaligned bytes.
+         */""")
+    codec_source_file.add_function_definition(load)
+
+    store = c.Function(
+        f"store_{suffix}",
+        qualifiers="static inline",
+        arguments=[c.Variable("bytes", "uint8_t *"), c.Variable("value", f"uint{width}_t")]
+    )
+    store.add_code((
+        f"#if __BYTE_ORDER__ == {swap}",
+        f"value = __builtin_bswap{width}(value);",
+        "#endif",
+        "memcpy(bytes, &value, sizeof(value));"
+    ))
+    codec_source_file.add_lines(f"""
+        /**
+         * \\brief Stores a {width}-bit value as {endianness} endian into unaligned bytes.
+         */""")
+    codec_source_file.add_function_definition(store)
+
+for function, _, _ in codec_functions:
+    codec_source_file.add_function_definition(function)
+    codec_source_file.add_function_definition(global_wrapper(function))
+
+codec_source_file.write_to_file("../frame_codec.c")
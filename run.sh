@@ -1,4 +1,4 @@
 #!/bin/bash
 bin/driver &
 sleep 1e-3
-bin/app
\ No newline at end of file
+bin/app "$@"
@@ -5,18 +5,37 @@
  *
  * \authors Lucas Pinard & Amélie Guédès
  */
+#define _GNU_SOURCE // pthread_setaffinity_np()
+#include <errno.h>
 #include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 
+#include "fifo.h"
 #include "lib/checksum.h"
 #include "lib/data_dictionary.h"
 #include "lib/drv_api.h"
+#include "lib/frame_codec.h"
+#include "src/drivers/driver.h"
+#include "src/logger/logger.h"
+#include "src/probes/probes.h"
+#include "src/realtime/realtime.h"
+#include "src/scheduler/scheduler.h"
+#include "src/sequence/sequence.h"
 #include "src/state_machines/fsm_blinkers.h"
 #include "src/state_machines/fsm_lights.h"
 #include "src/state_machines/fsm_wipers.h"
 
 #define LOW_FUEL_THRESHOLD 5
+#define MUX_OUT_PERIOD_CYCLES 2 // 20ms in cycles of 10ms
 
 /**
  * \brief List of serial numbers of devices connected to the BCGV by LNS.
@@ -26,20 +45,13 @@ typedef enum lns_serial_number_t {
   COMMODOS_SERIAL_NUMBER = 12,
 } lns_serial_number_t;
 
-/**
- * \brief List of masks to decode the commands byte of the LNS frame received
- * from the commodos.
- */
-typedef enum commodos_decode_masks_t {
-  COMMODOS_MASK_WARNINGS = (1 << 7),
-  COMMODOS_MASK_SIDELIGHTS = (1 << 6),
-  COMMODOS_MASK_HEADLIGHTS = (1 << 5),
-  COMMODOS_MASK_REDLIGHTS = (1 << 4),
-  COMMODOS_MASK_RIGHT_BLINKER = (1 << 3),
-  COMMODOS_MASK_LEFT_BLINKER = (1 << 2),
-  COMMODOS_MASK_WIPERS = (1 << 1),
-  COMMODOS_MASK_WASHERS = (1),
-} commodos_decode_masks_t;
+// The frames layouts of frames.csv must match the frames of the driver
+_Static_assert(FRAME_MUX_IN_SIZE == DRV_UDP_10MS_FRAME_SIZE,
+               "mux_in frame should be a 10ms UDP frame");
+_Static_assert(FRAME_MUX_OUT_SIZE == DRV_UDP_20MS_FRAME_SIZE,
+               "mux_out frame should be a 20ms UDP frame");
+_Static_assert(FRAME_COMMODOS_IN_SIZE == LNS_MAX_FRAME_SIZE,
+               "commodos_in frame should be a LNS frame");
 
 /**
  * \brief Decodes LNS frames from the commodos and sets application data
@@ -59,14 +71,6 @@ void decode_commodos(const uint8_t lns_frame_p[LNS_MAX_FRAME_SIZE],
 void decode_bgf(const uint8_t lns_frame_p[LNS_MAX_FRAME_SIZE],
                 size_t lns_frame_size_p);
 
-/**
- * \brief Decodes UDP frames from the MUX and sets application data
- * accordingly.
- *
- * \param[in] data_p The UDP frame.
- */
-void decode_mux(const uint8_t data_p[DRV_UDP_10MS_FRAME_SIZE]);
-
 #define BGF_OUT_FRAME_COUNT 5
 #define BGF_OUT_FRAME_SIZE 2
 
@@ -77,189 +81,901 @@ void decode_mux(const uint8_t data_p[DRV_UDP_10MS_FRAME_SIZE]);
 void encode_bgf(lns_frame_t lns_frame_p[DRV_MAX_FRAMES]);
 
 /**
- * \brief Creates and encodes the UDP frame for the MUX from application data.
- * \param[out] udp_frame_p Structure to fill with the UDP frame.
+ * \brief Main loop of the application: one cycle per UDP 10ms frame, reading
+ * the LNS frames received meanwhile.
  */
-void encode_mux(uint8_t udp_frame_p[DRV_UDP_20MS_FRAME_SIZE]);
+void main_loop(void);
 
 /**
- * \brief Main loop of the application.
+ * \brief Event loop of the application, used instead of the main loop: the
+ * cycles still follow the UDP 10ms frames and send the MUX frame every second
+ * cycle, but the LNS frames are handled as soon as they are received. For
+ * latency, the BGF frames due are also sent after each batch of LNS frames,
+ * so that the lights follow a command without waiting for the next cycle.
  */
-void main_loop(void);
+void event_loop(void);
+
+/**
+ * \brief Threaded loop of the application, used instead of the main loop: the
+ * calling thread owns the driver and passes the UDP frames and the batches
+ * of LNS frames read to a compute thread through two typed fifos, which sends
+ * the frames to write back through a third fifo.
+ *
+ * \param[in] io_cpu CPU of the calling thread, -1 to leave it unpinned.
+ * \param[in] compute_cpu CPU of the compute thread, -1 to leave it unpinned.
+ */
+void threaded_loop(int io_cpu, int compute_cpu);
+
+/**
+ * \brief Decodes the UDP 10ms frame read and checks the continuity of the MUX
+ * frame IDs.
+ */
+void process_mux_frame(void);
+
+/**
+ * \brief Decodes the LNS frames read.
+ */
+void process_lns_frames(void);
+
+/**
+ * \brief Runs the state machines and computes the indicators from the
+ * application data.
+ */
+void compute_application(void);
+
+/**
+ * \brief Runs the state machines on the LNS frames received between two
+ * cycles, without ticking their timers.
+ */
+void react_to_lns_frames(void);
+
+/**
+ * \brief Encodes and sends the MUX frame.
+ */
+void send_mux_frame(void);
+
+/**
+ * \brief Encodes and sends the BGF frames.
+ */
+void send_bgf_frames(void);
+
+/**
+ * \brief Publishes and saves the application data at the end of a cycle.
+ */
+void end_cycle(void);
+
+/**
+ * \brief Output tasks of the output scheduler.
+ */
+typedef enum output_task_t {
+  OUTPUT_TASK_MUX = 0,
+  OUTPUT_TASK_BGF = 1,
+  OUTPUT_TASK_COUNT = 2
+} output_task_t;
+
+/**
+ * \brief Checks whether an output must be sent now: the MUX frame every second
+ * cycle, the BGF frames always without the output scheduler and when their
+ * task is due otherwise. Called once per cycle for the MUX frame, as it counts
+ * the cycles, and for the BGF frames once per cycle and, by the event loop,
+ * after each batch of LNS frames.
+ *
+ * \param[in] task Output task.
+ * \return Whether the output must be sent.
+ */
+bool output_due(output_task_t task);
+
+/**
+ * \brief Parses a count of a command line option.
+ *
+ * \param[in] text Text of the option, decimal digits only.
+ * \param[out] count Parsed count.
+ * \return Whether the text is a count that fits in 64 bits.
+ */
+bool parse_count(const char *text, uint64_t *count);
 
 // Main function runtime variables
 
+const struct driver_t *driver;
 int32_t driver_fd;
 uint8_t out_udp_frame[DRV_UDP_10MS_FRAME_SIZE];
 lns_frame_t out_lns_frame[DRV_MAX_FRAMES];
 uint32_t out_lns_frame_count;
-uint32_t lns_status;
-mux_id_t last_read;
+int32_t lns_status;
+struct application_snapshot_t *snapshot; // NULL if no snapshot file is used
+// Application data of the last cycle, for the readers of other threads
+struct application_publication_t publication;
+// Periodic outputs: the MUX frame on the input cycles, the BGF frames on the
+// output scheduler if it is used
+uint64_t mux_cycle_count;
+bool output_scheduled;
+struct scheduler_task_t bgf_task;
+
+int main(int argc, char *argv[]) {
+
+  const char *snapshot_path = NULL;
+  uint64_t mock_cycle_count = 0;
+  const char *record_path = NULL;
+  const char *replay_path = NULL;
+  bool replay_real_time = false;
+  bool event_driven = false;
+  bool threaded = false;
+  int io_cpu = -1;
+  int compute_cpu = -1;
+  uint64_t bgf_period_ms = 0;
+  bool real_time = false;
+  struct realtime_config_t real_time_config;
+  driver = &driver_drv_api;
+  int option;
+  while ((option = getopt(argc, argv, "c:d:el:n:o:pr:R:s:t")) != -1) {
+    switch (option) {
+    case 'c':
+      if (sscanf(optarg, "%d,%d", &io_cpu, &compute_cpu) != 2) {
+        fprintf(stderr, "[ERROR] Expected CPUs \"io_cpu,compute_cpu\"\n");
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'd':
+      driver = driver_find(optarg);
+      if (driver == NULL) {
+        fprintf(stderr, "[ERROR] Unknown driver \"%s\"\n", optarg);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'e':
+      event_driven = true;
+      break;
+    case 'l':
+      replay_path = optarg;
+      break;
+    case 'n':
+      if (!parse_count(optarg, &mock_cycle_count)) {
+        fprintf(stderr, "[ERROR] Expected a count of mock cycles\n");
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'o':
+      if (!parse_count(optarg, &bgf_period_ms) || bgf_period_ms == 0) {
+        fprintf(stderr, "[ERROR] Expected a BGF period in ms\n");
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'p':
+      threaded = true;
+      break;
+    case 'r':
+      record_path = optarg;
+      break;
+    case 'R':
+      if (sscanf(optarg, "%d,%d", &real_time_config.cpu,
+                 &real_time_config.priority) != 2 ||
+          real_time_config.priority < 1 || real_time_config.priority > 99) {
+        fprintf(stderr, "[ERROR] Expected \"cpu,priority\", priority from 1 "
+                        "to 99\n");
+        return EXIT_FAILURE;
+      }
+      real_time = true;
+      break;
+    case 's':
+      snapshot_path = optarg;
+      break;
+    case 't':
+      replay_real_time = true;
+      break;
+    default:
+      fprintf(stderr,
+              "Usage: %s [-d drv_api|uring|mock|replay] [-e | -p [-c io_cpu,"
+              "compute_cpu]] [-n mock_cycle_count] [-l replay_log_file [-t]]"
+              " [-o bgf_period_ms] [-r record_log_file] [-R cpu,priority]"
+              " [-s snapshot_file]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  mock_driver_configure(NULL, 0, mock_cycle_count);
+  driver_replay_configure(replay_path, replay_real_time);
+  if (record_path != NULL) {
+    driver = driver_recorder_configure(driver, record_path);
+  }
 
-int main(void) {
+  lns_status = DRV_ERROR;
 
-  driver_fd = drv_open();
+  // Warnings of the loop are written by a background thread, started before
+  // the real-time mode so that it keeps the default policy
+  if (!logger_start()) {
+    perror("[ERROR] Failed to start logger");
+    return EXIT_FAILURE;
+  }
+
+  if (!PROBES_INIT()) {
+    perror("[ERROR] Failed to create stage probes");
+    return EXIT_FAILURE;
+  }
+
+  application_init();
+  mux_id_t last_read = 0;
+
+  // Warm restart: resume from the application data of the previous run
+  snapshot = NULL;
+  if (snapshot_path != NULL) {
+    snapshot = application_snapshot_open(snapshot_path);
+    if (snapshot == NULL) {
+      perror("[ERROR] Failed to open snapshot");
+      return EXIT_FAILURE;
+    }
+    if (application_snapshot_restore(snapshot)) {
+      last_read = get_mux_frame_id();
+    }
+  }
+
+  if (!sequence_init(last_read)) {
+    perror("[ERROR] Failed to create MUX sequence counters");
+    return EXIT_FAILURE;
+  }
+
+  driver_fd = driver->open();
 
   if (driver_fd == DRV_ERROR) {
     perror("[ERROR] Failed to open driver");
     return EXIT_FAILURE;
   }
 
-  lns_status = DRV_ERROR;
-  last_read = 0;
-
-  application_init();
+  // The BGF frames at their own period instead of on every 10ms cycle
+  output_scheduled = bgf_period_ms != 0;
+  scheduler_task_init(&bgf_task, "bgf_out",
+                      bgf_period_ms * SCHEDULER_NS_PER_MS, scheduler_now());
+
+  // Entered once the driver is open, so that its memory is locked as well, and
+  // before the threads are created, so that they inherit the policy
+  if (real_time) {
+    const struct realtime_region_t regions[] = {
+        {&application, sizeof(application)},
+        {&publication, sizeof(publication)},
+        {out_udp_frame, sizeof(out_udp_frame)},
+        {out_lns_frame, sizeof(out_lns_frame)},
+    };
+    if (!realtime_enter(&real_time_config, regions,
+                        sizeof(regions) / sizeof(regions[0]))) {
+      perror("[ERROR] Failed to enter real-time mode");
+      driver->close(driver_fd);
+      return EXIT_FAILURE;
+    }
+  }
 
-  main_loop();
+  if (event_driven) {
+    event_loop();
+  } else if (threaded) {
+    threaded_loop(io_cpu, compute_cpu);
+  } else {
+    main_loop();
+  }
 
   // If main loop is exited, program has failed
-  if (drv_close(driver_fd) == DRV_ERROR) {
+  if (driver->close(driver_fd) == DRV_ERROR) {
     perror("[ERROR] Failed to close driver");
   }
+  logger_stop();
+  if (output_scheduled) {
+    scheduler_report(&bgf_task, 1);
+  }
+  sequence_report();
+  PROBES_DUMP();
+  realtime_report();
+  if (snapshot != NULL) {
+    application_snapshot_close(snapshot);
+  }
   return EXIT_FAILURE;
 }
 
-#define MUX_ID_MAX 100
-
 void main_loop(void) {
 
 #pragma unroll
-  while (drv_read_udp_10ms(driver_fd, out_udp_frame) == DRV_SUCCESS) {
+  while (driver->read_udp_10ms(driver_fd, out_udp_frame) == DRV_SUCCESS) {
+    realtime_wakeup();
+    PROBE_START(cycle);
 
-    decode_mux(out_udp_frame);
+    // Setters record the variables changed during the current cycle only
+    application_clear_changes();
 
-    if (get_mux_frame_id() != (last_read % MUX_ID_MAX) + 1) {
-      if (fprintf(stderr,
-                  "[WARN] Received MUX frame ID (%" PRIu8 ")"
-                  " but expected (%" PRIu8 ")\n",
-                  get_mux_frame_id(), (last_read % MUX_ID_MAX) + 1) < 0) {
-        perror("[WARN] Failed to write to stderr");
-      }
-    }
-    last_read = get_mux_frame_id();
+    process_mux_frame();
 
-    lns_status = drv_read_lns(driver_fd, out_lns_frame, &out_lns_frame_count);
+    lns_status =
+        driver->read_lns(driver_fd, out_lns_frame, &out_lns_frame_count);
     if (lns_status == DRV_ERROR) {
       perror("[ERROR] Failed to read from LNS");
       return;
     }
+    process_lns_frames();
 
-#pragma unroll 2
-    for (size_t i = 0; i < out_lns_frame_count; i++) {
+    compute_application();
+
+    if (output_due(OUTPUT_TASK_MUX)) {
+      send_mux_frame();
+    }
+    if (output_due(OUTPUT_TASK_BGF)) {
+      send_bgf_frames();
+    }
+
+    end_cycle();
+    PROBE(cycle, PROBE_STAGE_CYCLE);
+  }
 
-      switch (out_lns_frame[i].serNum) {
+  perror("[ERROR] Failed to read from UDP");
+}
+
+/**
+ * \brief Sources of the events of the event loop.
+ */
+typedef enum event_source_t {
+  EVENT_SOURCE_UDP = 0,
+  EVENT_SOURCE_LNS = 1,
+  EVENT_SOURCE_COUNT = 2
+} event_source_t;
+
+void event_loop(void) {
+
+  if (driver->channel_fd == NULL || driver->read_udp_received == NULL) {
+    fprintf(stderr, "[ERROR] Driver \"%s\" can't be polled\n", driver->name);
+    return;
+  }
+  int fds[EVENT_SOURCE_COUNT];
+  fds[EVENT_SOURCE_UDP] =
+      driver->channel_fd(driver_fd, DRIVER_CHANNEL_UDP_10MS);
+  fds[EVENT_SOURCE_LNS] = driver->channel_fd(driver_fd, DRIVER_CHANNEL_LNS);
+  if (fds[EVENT_SOURCE_UDP] == -1 || fds[EVENT_SOURCE_LNS] == -1) {
+    perror("[ERROR] Failed to find driver channels");
+    return;
+  }
+
+  int epoll_fd = epoll_create1(0);
+  if (epoll_fd == -1) {
+    perror("[ERROR] Failed to create epoll instance");
+    return;
+  }
+  for (uint32_t source = 0; source < EVENT_SOURCE_COUNT; source++) {
+    struct epoll_event event = {.events = EPOLLIN, .data.u32 = source};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[source], &event) == -1) {
+      perror("[ERROR] Failed to poll driver");
+      close(epoll_fd);
+      return;
+    }
+  }
 
-      case BGF_SERIAL_NUMBER:
-        decode_bgf(out_lns_frame[i].frame, out_lns_frame[i].frameSize);
+  for (;;) {
+    struct epoll_event events[EVENT_SOURCE_COUNT];
+    int event_count = epoll_wait(epoll_fd, events, EVENT_SOURCE_COUNT, -1);
+    if (event_count == -1 && errno != EINTR) {
+      perror("[ERROR] Failed to wait for events");
+      break;
+    }
+
+    for (int i = 0; i < event_count; i++) {
+      switch (events[i].data.u32) {
+
+      case EVENT_SOURCE_UDP:
+        // Cycle of 10ms: the state machines timers tick
+        if (driver->read_udp_received(driver_fd, out_udp_frame) ==
+            DRV_ERROR) {
+          perror("[ERROR] Failed to read from UDP");
+          goto exit;
+        }
+        realtime_wakeup();
+        PROBE_START(cycle);
+        application_clear_changes();
+        process_mux_frame();
+        compute_application();
+        if (output_due(OUTPUT_TASK_MUX)) {
+          send_mux_frame();
+        }
+        if (output_due(OUTPUT_TASK_BGF)) {
+          send_bgf_frames();
+        }
+        end_cycle();
+        PROBE(cycle, PROBE_STAGE_CYCLE);
         break;
 
-      case COMMODOS_SERIAL_NUMBER:
-        decode_commodos(out_lns_frame[i].frame, out_lns_frame[i].frameSize);
+      case EVENT_SOURCE_LNS:
+        // Commands and acknowledgements are handled as soon as they arrive,
+        // between two cycles
+        lns_status =
+            driver->read_lns(driver_fd, out_lns_frame, &out_lns_frame_count);
+        if (lns_status == DRV_ERROR) {
+          perror("[ERROR] Failed to read from LNS");
+          goto exit;
+        }
+        if (out_lns_frame_count > 0) {
+          process_lns_frames();
+          react_to_lns_frames();
+          // Sent now rather than at the next cycle, for latency: without the
+          // output scheduler, this adds a BGF send per batch of LNS frames
+          if (output_due(OUTPUT_TASK_BGF)) {
+            send_bgf_frames();
+          }
+        }
         break;
       }
     }
+  }
 
-    // Run state machines
-    compute_sidelights();
-    compute_headlights();
-    compute_redlights();
+exit:
+  close(epoll_fd);
+}
 
-    compute_left_blinker();
-    compute_right_blinker();
+/**
+ * \brief Pins a thread to a CPU.
+ *
+ * \param[in] thread Thread.
+ * \param[in] cpu CPU, -1 to leave the thread unpinned.
+ * \return Whether the thread is pinned or left unpinned.
+ */
+static bool pin_thread(pthread_t thread, int cpu) {
 
-    compute_wipers();
+  if (cpu < 0) {
+    return true;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  int error = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+  if (error != 0) {
+    errno = error;
+    perror("[ERROR] Failed to pin thread");
+    return false;
+  }
+  return true;
+}
 
-    // Transfer remaining IN signals to OUT signals
-    set_indicator_tire_pressure(get_frame_flags() &
-                                FRAME_FLAGS_MASK_TIRE_PRESSURE);
-    set_indicator_pads_failure(get_frame_flags() & FRAME_FLAGS_MASK_BRAKE_PADS);
+#define THREADED_OUTPUT_FIFO 1
+#define THREADED_CYCLE_OUTPUTS 3 // UDP 20ms, LNS and end of cycle
+// Cycles read ahead of the outputs written, so that no fifo can be full
+#define THREADED_MAX_CYCLES_AHEAD (FIFO_MAX_ITEMS / THREADED_CYCLE_OUTPUTS)
+#define THREADED_STOP UINT32_MAX // Frame count of the batch ending the loop
+
+// Inputs of the threaded loop, one UDP frame and one LNS batch per cycle
+static _Alignas(FIFO_ALIGNMENT) uint8_t mux_in_memory[FIFO_MEMORY_SIZE(
+    sizeof(fifo_udp_frame_t), FIFO_MAX_ITEMS)];
+static _Alignas(FIFO_ALIGNMENT) uint8_t lns_in_memory[FIFO_MEMORY_SIZE(
+    sizeof(fifo_lns_batch_t), FIFO_MAX_ITEMS)];
+static udp_frame_fifo_t *mux_in;
+static lns_batch_fifo_t *lns_in;
+// Set by the compute thread when it stops on a failure
+static atomic_bool threaded_failed;
 
-    set_indicator_motor_pressure(get_motor_flags() &
-                                 MOTOR_FLAGS_MASK_MOTOR_PRESSURE);
-    set_indicator_coolant_overheat(get_motor_flags() &
-                                   MOTOR_FLAGS_MASK_COOLANT_TEMPERATURE);
-    set_indicator_oil_overheat(get_motor_flags() &
-                               MOTOR_FLAGS_MASK_OIL_TEMPERATURE);
+/**
+ * \brief Stops the compute thread of the threaded loop on a failure, waking
+ * the I/O thread up so that it stops too.
+ *
+ * \param[in] output Output fifo.
+ * \param[in] message Description of the failure.
+ * \return NULL, the result of the compute thread.
+ */
+static void *compute_failure(hsi_fifo_t *output, const char *message) {
+
+  fprintf(stderr, "[ERROR] %s\n", message);
+  atomic_store(&threaded_failed, true);
+  fifo_commit(output, 0); // Wakes the I/O thread up, without output
+  return NULL;
+}
+
+/**
+ * \brief Compute thread of the threaded loop: runs the cycles of the main loop
+ * on the frames of the input fifos, and pushes the frames to write into the
+ * output fifo.
+ *
+ * \param[in] argument Unused.
+ * \return NULL.
+ */
+static void *compute_thread(void *argument) {
+
+  (void)argument;
+  hsi_fifo_t *output = fifo_get_instance_pointer(THREADED_OUTPUT_FIFO);
+  fifo_span_t frames;
+  fifo_span_t batches;
+  fifo_span_t outputs;
+  PROBE_START(cycle);
+
+  for (;;) {
+    // The LNS batch is the last input of a cycle, pushed after its UDP frame.
+    // Both are read in place in the fifos, released once decoded.
+    int32_t status;
+    while ((status = lns_batch_fifo_peek(lns_in, 1, &batches)) == FIFO_EMPTY) {
+      lns_batch_fifo_wait(lns_in, -1);
+    }
+    if (status != FIFO_DATA) {
+      return compute_failure(output, "Failed to read a LNS batch");
+    }
+    const fifo_lns_batch_t *batch = lns_batch_fifo_item(&batches, 0);
+    if (batch->frame_count == THREADED_STOP) {
+      return NULL;
+    }
+
+    PROBE_RESTART(cycle);
+    // Setters record the variables changed during the current cycle only
+    application_clear_changes();
+    // Pushed before the LNS batch, always there
+    if (udp_frame_fifo_peek(mux_in, 1, &frames) != FIFO_DATA) {
+      return compute_failure(output, "Failed to read a UDP frame");
+    }
+    memcpy(out_udp_frame, udp_frame_fifo_item(&frames, 0)->frame,
+           DRV_UDP_10MS_FRAME_SIZE);
+    udp_frame_fifo_release(mux_in, 1);
+    process_mux_frame();
+
+    memcpy(out_lns_frame, batch->frames,
+           batch->frame_count * sizeof(lns_frame_t));
+    out_lns_frame_count = batch->frame_count;
+    lns_batch_fifo_release(lns_in, 1);
+    process_lns_frames();
+
+    compute_application();
+
+    // Encoded in the buffers of the main loop, for the same output, and
+    // published with the end of the cycle at once
+    if (fifo_reserve(output, THREADED_CYCLE_OUTPUTS, &outputs) != FIFO_DATA) {
+      return compute_failure(output, "Failed to reserve the outputs");
+    }
+    uint32_t output_count = 0;
+    fifo_item_t *out;
+    if (output_due(OUTPUT_TASK_MUX)) {
+      PROBE_START(clock);
+      encode_mux_out_frame(out_udp_frame);
+      PROBE(clock, PROBE_STAGE_ENCODE_MUX);
+      out = fifo_span_item(&outputs, output_count++);
+      out->type = FIFO_ITEM_UDP_20MS;
+      memcpy(out->udp_frame, out_udp_frame, DRV_UDP_20MS_FRAME_SIZE);
+    }
+    if (output_due(OUTPUT_TASK_BGF)) {
+      PROBE_START(clock);
+      encode_bgf(out_lns_frame);
+      PROBE(clock, PROBE_STAGE_ENCODE_BGF);
+      out = fifo_span_item(&outputs, output_count++);
+      out->type = FIFO_ITEM_LNS_OUT;
+      memcpy(out->lns_frames, out_lns_frame,
+             BGF_OUT_FRAME_COUNT * sizeof(lns_frame_t));
+      out->lns_frame_count = BGF_OUT_FRAME_COUNT;
+    }
+    out = fifo_span_item(&outputs, output_count++);
+    out->type = FIFO_ITEM_CYCLE_END;
+    fifo_commit(output, output_count);
+
+    end_cycle();
+    PROBE(cycle, PROBE_STAGE_CYCLE);
+  }
+}
+
+/**
+ * \brief Writes with the driver the frames of the output fifo, without waiting
+ * for the compute thread.
+ *
+ * \param[in] output Output fifo.
+ * \return Number of cycles whose frames are all written.
+ */
+static uint32_t write_outputs(hsi_fifo_t *output) {
+
+  uint32_t cycles = 0;
+  fifo_span_t span;
+  while (fifo_peek(output, FIFO_MAX_ITEMS, &span) == FIFO_DATA) {
+    uint32_t count = span.first_count + span.second_count;
+    for (uint32_t i = 0; i < count; i++) {
+      fifo_item_t *out = fifo_span_item(&span, i);
+      PROBE_START(clock);
+      if (out->type == FIFO_ITEM_UDP_20MS) {
+        if (driver->write_udp_20ms(driver_fd, out->udp_frame) == DRV_ERROR) {
+          perror("[ERROR] Failed to write to UDP");
+        }
+        PROBE(clock, PROBE_STAGE_WRITE_UDP);
+      }
+      if (out->type == FIFO_ITEM_LNS_OUT) {
+        if (driver->write_lns(driver_fd, out->lns_frames,
+                              out->lns_frame_count) == DRV_ERROR) {
+          perror("[ERROR] Failed to write to LNS");
+        }
+        PROBE(clock, PROBE_STAGE_WRITE_LNS);
+      }
+      cycles += out->type == FIFO_ITEM_CYCLE_END;
+    }
+    fifo_release(output, count);
+  }
+  return cycles;
+}
 
-    set_indicator_low_fuel(get_tank_level() < LOW_FUEL_THRESHOLD);
+/**
+ * \brief Sources polled by the I/O thread of the threaded loop.
+ */
+typedef enum io_source_t {
+  IO_SOURCE_UDP = 0,
+  IO_SOURCE_OUTPUT = 1,
+  IO_SOURCE_COUNT = 2
+} io_source_t;
+
+/**
+ * \brief Waits until a UDP 10ms frame is received, writing the frames of the
+ * output fifo as soon as the compute thread pushes them.
+ *
+ * \param[in] fds Polled file descriptors, indexed by io_source_t.
+ * \param[in] output Output fifo.
+ * \param[in,out] cycles_ahead Cycles read whose frames aren't all written.
+ * \return Whether a frame is received, false on failure (errno is set).
+ */
+static bool wait_udp_frame(struct pollfd fds[IO_SOURCE_COUNT],
+                           hsi_fifo_t *output, uint32_t *cycles_ahead) {
+
+  for (;;) {
+    // Asleep only if no output is left to write
+    bool asleep = fifo_prepare_wait(output) == FIFO_EMPTY;
+    int ready = poll(fds, IO_SOURCE_COUNT, asleep ? -1 : 0);
+    if (asleep) {
+      fifo_finish_wait(output);
+    }
+    *cycles_ahead -= write_outputs(output);
+    if (ready == -1 && errno != EINTR) {
+      return false;
+    }
+    if (ready > 0 && fds[IO_SOURCE_UDP].revents != 0) {
+      return true;
+    }
+  }
+}
+
+void threaded_loop(int io_cpu, int compute_cpu) {
+
+  static const fifo_lns_batch_t stop = {.frame_count = THREADED_STOP};
+  mux_in = udp_frame_fifo_create(mux_in_memory, sizeof(mux_in_memory),
+                                 FIFO_MAX_ITEMS, FIFO_BLOCK);
+  lns_in = lns_batch_fifo_create(lns_in_memory, sizeof(lns_in_memory),
+                                 FIFO_MAX_ITEMS, FIFO_BLOCK);
+  hsi_fifo_t *output = fifo_init_instance(THREADED_OUTPUT_FIFO);
+  atomic_init(&threaded_failed, false);
+
+  // Drivers that can be polled are, along with the output fifo, so that the
+  // frames computed are written without waiting for the next UDP frame. The
+  // frames of the others are always ready.
+  bool polled = driver->channel_fd != NULL && driver->read_udp_received != NULL;
+  struct pollfd fds[IO_SOURCE_COUNT] = {{.fd = -1}, {.fd = -1}};
+  if (polled) {
+    fds[IO_SOURCE_UDP].fd =
+        driver->channel_fd(driver_fd, DRIVER_CHANNEL_UDP_10MS);
+    fds[IO_SOURCE_UDP].events = POLLIN;
+    fds[IO_SOURCE_OUTPUT].fd = fifo_notify_fd(output);
+    fds[IO_SOURCE_OUTPUT].events = POLLIN;
+    if (fds[IO_SOURCE_UDP].fd == -1 || fds[IO_SOURCE_OUTPUT].fd == -1) {
+      perror("[ERROR] Failed to poll driver");
+      return;
+    }
+  }
 
-    set_indicator_battery_low(get_battery_flags_in() & BATTERY_FLAGS_MASK_LOW);
-    set_indicator_battery_failure(get_battery_flags_in() &
-                                  BATTERY_FLAGS_MASK_FAILURE);
+  pthread_t compute;
+  int error = pthread_create(&compute, NULL, compute_thread, NULL);
+  if (error != 0) {
+    errno = error;
+    perror("[ERROR] Failed to create compute thread");
+    return;
+  }
+  if (!pin_thread(pthread_self(), io_cpu) ||
+      !pin_thread(compute, compute_cpu)) {
+    goto exit;
+  }
 
-    set_indicator_motor_failure(false); // No input for that
-    set_indicator_brake_failure(false); // No input for that
+  // The driver is only used by this thread, the application data only by the
+  // compute thread. The frames are read into and written from the fifos, which
+  // block when full so that no frame is dropped. The frames computed are
+  // written as they come, this thread reading the next cycle meanwhile.
+  fifo_span_t span;
+  uint32_t cycles_ahead = 0;
+  for (;;) {
+    cycles_ahead -= write_outputs(output);
+    if (atomic_load(&threaded_failed)) {
+      break;
+    }
+    if (cycles_ahead == THREADED_MAX_CYCLES_AHEAD) {
+      // The compute thread is behind, the fifos would be full
+      fifo_wait(output, -1);
+      continue;
+    }
 
-    // Encoding and sending UDP
-    encode_mux(out_udp_frame);
-    if (drv_write_udp_20ms(driver_fd, out_udp_frame) == DRV_ERROR) {
-      perror("[ERROR] Failed to write to UDP");
+    if (polled && !wait_udp_frame(fds, output, &cycles_ahead)) {
+      perror("[ERROR] Failed to wait for UDP");
+      break;
+    }
+    if (udp_frame_fifo_reserve(mux_in, 1, &span) != FIFO_DATA) {
+      fprintf(stderr, "[ERROR] Failed to reserve a UDP frame\n");
+      break;
     }
+    fifo_udp_frame_t *frame = udp_frame_fifo_item(&span, 0);
+    if ((polled ? driver->read_udp_received(driver_fd, frame->frame)
+                : driver->read_udp_10ms(driver_fd, frame->frame)) ==
+        DRV_ERROR) {
+      perror("[ERROR] Failed to read from UDP");
+      break;
+    }
+    realtime_wakeup();
+    udp_frame_fifo_commit(mux_in, 1);
 
-    // Encoding and sending LNS
-    encode_bgf(out_lns_frame);
-    if (drv_write_lns(driver_fd, out_lns_frame, BGF_OUT_FRAME_COUNT) ==
+    if (lns_batch_fifo_reserve(lns_in, 1, &span) != FIFO_DATA) {
+      fprintf(stderr, "[ERROR] Failed to reserve a LNS batch\n");
+      break;
+    }
+    fifo_lns_batch_t *batch = lns_batch_fifo_item(&span, 0);
+    if (driver->read_lns(driver_fd, batch->frames, &batch->frame_count) ==
         DRV_ERROR) {
-      perror("[ERROR] Failed to write to LNS");
+      perror("[ERROR] Failed to read from LNS");
+      break;
     }
+    lns_batch_fifo_commit(lns_in, 1);
+    cycles_ahead++;
   }
 
-  perror("[ERROR] Failed to read from UDP");
+exit:
+  lns_batch_fifo_push(lns_in, &stop);
+  pthread_join(compute, NULL);
+  // Frames of the last cycles computed
+  write_outputs(output);
 }
 
-void decode_commodos(const uint8_t *lns_frame_p, size_t lns_frame_size_p) {
+bool output_due(output_task_t task) {
 
-  if (lns_frame_size_p < 2) { // Only frames treated are 2B
-    return;
+  // On the count of input cycles rather than on the clock, so that the MUX
+  // frame follows the inputs without jitter and a replay sends it identically
+  if (task == OUTPUT_TASK_MUX) {
+    return mux_cycle_count++ % MUX_OUT_PERIOD_CYCLES == 0;
   }
-  // Little Endian : CRC8 is on first byte
-  uint8_t crc_8_byte = lns_frame_p[0];
-  uint8_t command_byte = lns_frame_p[1];
+  return !output_scheduled || scheduler_task_due(&bgf_task, scheduler_now());
+}
 
-  set_commodos_crc_8(crc_8_byte);
-  uint8_t computed_crc_8 = crc_8(&command_byte, 1);
+bool parse_count(const char *text, uint64_t *count) {
 
-  if (get_commodos_crc_8() != computed_crc_8) {
-    if (fprintf(stderr,
-                "[WARN] Checksum verification failed"
-                " (expected %" PRIX8 ", found %" PRIX8 ")\n",
-                get_commodos_crc_8(), computed_crc_8) < 0) {
-      perror("[WARN] Failed to write to stderr");
+  // strtoull() accepts a sign and stops at the first non-digit
+  if (*text < '0' || *text > '9') {
+    return false;
+  }
+  char *end;
+  errno = 0;
+  unsigned long long value = strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0') {
+    return false;
+  }
+  *count = value;
+  return true;
+}
+
+void process_mux_frame(void) {
+
+  PROBE_START(clock);
+  decode_mux_in_frame(out_udp_frame);
+
+  // Frames lost, duplicated and reordered are counted for monitoring
+  uint8_t expected = sequence_last_id() % SEQUENCE_ID_MAX + 1;
+  sequence_track(get_mux_frame_id());
+  if (get_mux_frame_id() != expected) {
+    logger_log(LOGGER_MUX_ID_MISMATCH, get_mux_frame_id(), expected);
+  }
+  PROBE(clock, PROBE_STAGE_DECODE_MUX);
+}
+
+void process_lns_frames(void) {
+
+  PROBE_START(clock);
+#pragma unroll 2
+  for (size_t i = 0; i < out_lns_frame_count; i++) {
+
+    switch (out_lns_frame[i].serNum) {
+
+    case BGF_SERIAL_NUMBER:
+      decode_bgf(out_lns_frame[i].frame, out_lns_frame[i].frameSize);
+      break;
+
+    case COMMODOS_SERIAL_NUMBER:
+      decode_commodos(out_lns_frame[i].frame, out_lns_frame[i].frameSize);
+      break;
     }
   }
+  PROBE(clock, PROBE_STAGE_DECODE_LNS);
+}
+
+void compute_application(void) {
+
+  PROBE_START(clock);
+
+  // Run state machines
+  compute_sidelights();
+  PROBE(clock, PROBE_STAGE_FSM_SIDELIGHTS);
+  compute_headlights();
+  PROBE(clock, PROBE_STAGE_FSM_HEADLIGHTS);
+  compute_redlights();
+  PROBE(clock, PROBE_STAGE_FSM_REDLIGHTS);
+
+  compute_left_blinker();
+  PROBE(clock, PROBE_STAGE_FSM_LEFT_BLINKER);
+  compute_right_blinker();
+  PROBE(clock, PROBE_STAGE_FSM_RIGHT_BLINKER);
+
+  compute_wipers();
+  PROBE(clock, PROBE_STAGE_FSM_WIPERS);
+
+  // Transfer remaining IN signals to OUT signals
+  set_indicator_tire_pressure(get_frame_flags() &
+                              FRAME_FLAGS_MASK_TIRE_PRESSURE);
+  set_indicator_pads_failure(get_frame_flags() & FRAME_FLAGS_MASK_BRAKE_PADS);
+
+  set_indicator_motor_pressure(get_motor_flags() &
+                               MOTOR_FLAGS_MASK_MOTOR_PRESSURE);
+  set_indicator_coolant_overheat(get_motor_flags() &
+                                 MOTOR_FLAGS_MASK_COOLANT_TEMPERATURE);
+  set_indicator_oil_overheat(get_motor_flags() &
+                             MOTOR_FLAGS_MASK_OIL_TEMPERATURE);
+
+  set_indicator_low_fuel(get_tank_level() < LOW_FUEL_THRESHOLD);
+
+  set_indicator_battery_low(get_battery_flags_in() & BATTERY_FLAGS_MASK_LOW);
+  set_indicator_battery_failure(get_battery_flags_in() &
+                                BATTERY_FLAGS_MASK_FAILURE);
+
+  set_indicator_motor_failure(false); // No input for that
+  set_indicator_brake_failure(false); // No input for that
+  PROBE(clock, PROBE_STAGE_INDICATORS);
+}
+
+void react_to_lns_frames(void) {
+
+  // Only the command and acknowledgement events, the time-based ones being
+  // evaluated on the cycles
+  react_sidelights();
+  react_headlights();
+  react_redlights();
+  react_left_blinker();
+  react_right_blinker();
+  react_wipers();
+}
+
+void send_mux_frame(void) {
+
+  PROBE_START(clock);
+  encode_mux_out_frame(out_udp_frame);
+  PROBE(clock, PROBE_STAGE_ENCODE_MUX);
+  if (driver->write_udp_20ms(driver_fd, out_udp_frame) == DRV_ERROR) {
+    perror("[ERROR] Failed to write to UDP");
+  }
+  PROBE(clock, PROBE_STAGE_WRITE_UDP);
+}
+
+void send_bgf_frames(void) {
+
+  PROBE_START(clock);
+  encode_bgf(out_lns_frame);
+  PROBE(clock, PROBE_STAGE_ENCODE_BGF);
+  if (driver->write_lns(driver_fd, out_lns_frame, BGF_OUT_FRAME_COUNT) ==
+      DRV_ERROR) {
+    perror("[ERROR] Failed to write to LNS");
+  }
+  PROBE(clock, PROBE_STAGE_WRITE_LNS);
+}
+
+void end_cycle(void) {
+
+  application_publish(&publication);
+
+  // Memory writes only, the kernel writes the snapshot file back
+  if (snapshot != NULL) {
+    application_snapshot_save(snapshot);
+  }
 
-  // Extract commands from command_byte
-  set_warnings_in(command_byte & COMMODOS_MASK_WARNINGS);
-  set_sidelights_in(command_byte & COMMODOS_MASK_SIDELIGHTS);
-  set_headlights_in(command_byte & COMMODOS_MASK_HEADLIGHTS);
-  set_redlights_in(command_byte & COMMODOS_MASK_REDLIGHTS);
-  set_left_blinker_in(command_byte & COMMODOS_MASK_LEFT_BLINKER);
-  set_right_blinker_in(command_byte & COMMODOS_MASK_RIGHT_BLINKER);
-  set_wipers_in(command_byte & COMMODOS_MASK_WIPERS);
-  set_washer_fluid_in(command_byte & COMMODOS_MASK_WASHERS);
+  PROBES_POLL();
 }
 
-// MUX decoding filters
-#define FILTER_MUX_FRAME_ID(data) data[0]
-#define FILTER_FRAME_MILEAGE(data)                                             \
-  ((data_p[1] << 24) + (data_p[2] << 16) + (data_p[3] << 8) + data_p[4])
-#define FILTER_FRAME_SPEED(data) data[5]
-#define FILTER_FRAME_FLAGS(data) data[6]
-#define FILTER_MOTOR_FLAGS(data) data[7]
-#define FILTER_TANK_LEVEL(data) data[8]
-#define FILTER_MOTOR_SPEED(data)                                               \
-  ((data_p[9] << 24) + (data_p[10] << 16) + (data_p[11] << 8) + data_p[12])
-#define FILTER_BATTERY_FLAGS(data) data[13]
-
-void decode_mux(const uint8_t data_p[DRV_UDP_10MS_FRAME_SIZE]) {
-  set_mux_frame_id(FILTER_MUX_FRAME_ID(data_p));
-  set_frame_mileage(FILTER_FRAME_MILEAGE(data_p));
-  set_frame_speed(FILTER_FRAME_SPEED(data_p));
-  set_frame_flags(FILTER_FRAME_FLAGS(data_p));
-  set_motor_flags(FILTER_MOTOR_FLAGS(data_p));
-  set_tank_level(FILTER_TANK_LEVEL(data_p));
-  set_motor_speed(FILTER_MOTOR_SPEED(data_p));
-  set_battery_flags_in(FILTER_BATTERY_FLAGS(data_p));
+void decode_commodos(const uint8_t *lns_frame_p, size_t lns_frame_size_p) {
+
+  if (lns_frame_size_p < FRAME_COMMODOS_IN_SIZE) { // Only frames treated are 2B
+    return;
+  }
+
+  // CRC8 is on first byte, commands on second byte (see frames.csv)
+  decode_commodos_in_frame(lns_frame_p);
+  uint8_t computed_crc_8 = crc_8(&lns_frame_p[1], 1);
+
+  if (get_commodos_crc_8() != computed_crc_8) {
+    logger_log(LOGGER_COMMODOS_CRC_MISMATCH, get_commodos_crc_8(),
+               computed_crc_8);
+  }
 }
 
 /**
@@ -353,76 +1069,3 @@ void decode_bgf(const uint8_t *lns_frame_p, size_t lns_frame_size_p) {
     break;
   }
 }
-
-/**
- * \brief Constants used for encoding the MUX out frame.
- */
-typedef enum mux_encoding_constants_t {
-  MUX_OUT_FRAME_FIRST_BYTE = 0,
-  MUX_OUT_FRAME_SECOND_BYTE = 1,
-  MUX_OUT_FRAME_THIRD_BYTE = 2,
-  MUX_OUT_FRAME_FOURTH_BYTE = 3,
-  MUX_OUT_FRAME_FIFTH_BYTE = 4,
-  MUX_OUT_FRAME_SIXTH_BYTE = 5,
-  MUX_OUT_FRAME_SEVENTH_BYTE = 6,
-  MUX_OUT_FRAME_EIGHTH_BYTE = 7,
-  MUX_OUT_FRAME_NINTH_BYTE = 8,
-
-  MUX_OUT_OFFSET_SIDELIGHTS = 7,
-  MUX_OUT_OFFSET_HEADLIGHTS = 6,
-  MUX_OUT_OFFSET_REDLIGHTS = 5,
-  MUX_OUT_OFFSET_LOW_FUEL = 4,
-  MUX_OUT_OFFSET_MOTOR_FAILURE = 3,
-  MUX_OUT_OFFSET_TIRE_PRESSURE = 2,
-  MUX_OUT_OFFSET_PADS_FAILURE = 1,
-  MUX_OUT_OFFSET_BATTERY_LOW = 0,
-
-  MUX_OUT_OFFSET_WARNINGS = 7,
-  MUX_OUT_OFFSET_BATTERY_FAILURE = 6,
-  MUX_OUT_OFFSET_COOLANT_OVERHEAT = 5,
-  MUX_OUT_OFFSET_MOTOR_PRESSURE = 4,
-  MUX_OUT_OFFSET_OIL_OVERHEAT = 3,
-  MUX_OUT_OFFSET_BRAKE_FAILURE = 2,
-  MUX_OUT_OFFSET_WIPERS_OUT = 1,
-  MUX_OUT_OFFSET_WASHER_FLUID_OUT = 0,
-} mux_encoding_constants_t;
-
-// Macros for encoding the mileage bytes (big endian)
-#define ENCODE_MILEAGE_FIRST_BYTE(v_int32) (0xFFFF & (v_int32 >> 24))
-#define ENCODE_MILEAGE_SECOND_BYTE(v_int32) (0xFFFF & (v_int32 >> 16))
-#define ENCODE_MILEAGE_THIRD_BYTE(v_int32) (0xFFFF & (v_int32 >> 8))
-#define ENCODE_MILEAGE_FOURTH_BYTE(v_int32) (0xFFFF & v_int32)
-
-void encode_mux(uint8_t udp_frame_p[DRV_UDP_20MS_FRAME_SIZE]) {
-
-  udp_frame_p[MUX_OUT_FRAME_FIRST_BYTE] =
-      (get_indicator_sidelights() << MUX_OUT_OFFSET_SIDELIGHTS) +
-      (get_indicator_headlights() << MUX_OUT_OFFSET_HEADLIGHTS) +
-      (get_indicator_redlights() << MUX_OUT_OFFSET_REDLIGHTS) +
-      (get_indicator_low_fuel() << MUX_OUT_OFFSET_LOW_FUEL) +
-      (get_indicator_motor_failure() << MUX_OUT_OFFSET_MOTOR_FAILURE) +
-      (get_indicator_tire_pressure() << MUX_OUT_OFFSET_TIRE_PRESSURE) +
-      (get_indicator_pads_failure() << MUX_OUT_OFFSET_PADS_FAILURE) +
-      (get_indicator_battery_low() << MUX_OUT_OFFSET_BATTERY_LOW);
-
-  udp_frame_p[MUX_OUT_FRAME_SECOND_BYTE] =
-      (get_indicator_warnings() << MUX_OUT_OFFSET_WARNINGS) +
-      (get_indicator_battery_failure() << MUX_OUT_OFFSET_BATTERY_FAILURE) +
-      (get_indicator_coolant_overheat() << MUX_OUT_OFFSET_COOLANT_OVERHEAT) +
-      (get_indicator_motor_pressure() << MUX_OUT_OFFSET_MOTOR_PRESSURE) +
-      (get_indicator_oil_overheat() << MUX_OUT_OFFSET_OIL_OVERHEAT) +
-      (get_indicator_brake_failure() << MUX_OUT_OFFSET_BRAKE_FAILURE) +
-      (get_wipers_out() << MUX_OUT_OFFSET_WIPERS_OUT) +
-      (get_washer_fluid_out() << MUX_OUT_OFFSET_WASHER_FLUID_OUT);
-
-  frame_mileage_t mileage = get_frame_mileage();
-
-  udp_frame_p[MUX_OUT_FRAME_THIRD_BYTE] = ENCODE_MILEAGE_FIRST_BYTE(mileage);
-  udp_frame_p[MUX_OUT_FRAME_FOURTH_BYTE] = ENCODE_MILEAGE_SECOND_BYTE(mileage);
-  udp_frame_p[MUX_OUT_FRAME_FIFTH_BYTE] = ENCODE_MILEAGE_THIRD_BYTE(mileage);
-  udp_frame_p[MUX_OUT_FRAME_SIXTH_BYTE] = ENCODE_MILEAGE_FOURTH_BYTE(mileage);
-
-  udp_frame_p[MUX_OUT_FRAME_SEVENTH_BYTE] = get_frame_speed();
-  udp_frame_p[MUX_OUT_FRAME_EIGHTH_BYTE] = get_tank_level();
-  udp_frame_p[MUX_OUT_FRAME_NINTH_BYTE] = get_motor_speed();
-}
@@ -0,0 +1,218 @@
+/**
+ * \brief This file benchmarks the fifo between two threads, as used by the
+ * threaded loop: the throughput of a stream of items, and the latency of an
+ * item going to the other thread and back through a second fifo.
+ *
+ * Build with make bin/fifo_bench, and with FIFO_SOURCE=<file> to benchmark
+ * another implementation of fifo.h. Only the functions of the first fifo.h are
+ * used, so that the previous versions can be compared: the second fifo of the
+ * round trip comes from a second copy of FIFO_SOURCE linked by the Makefile.
+ * The threads are pinned to the CPUs given as arguments, to measure the fifo
+ * across cores.
+ */
+#define _GNU_SOURCE // pthread_setaffinity_np()
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fifo.h"
+
+#define BENCH_STREAM_ITEMS 10000000
+#define BENCH_ROUND_TRIPS 200000
+
+static int bench_consumer_cpu = -1;
+
+/**
+ * \brief fifo_init() of the second copy of FIFO_SOURCE.
+ *
+ * \return The fifo of the second copy.
+ */
+hsi_fifo_t *fifo_backward_init(void);
+
+/**
+ * \brief fifo_get_pointer() of the second copy of FIFO_SOURCE.
+ *
+ * \return The fifo of the second copy.
+ */
+hsi_fifo_t *fifo_backward_get_pointer(void);
+
+/**
+ * \brief Returns CLOCK_MONOTONIC.
+ *
+ * \return CLOCK_MONOTONIC, in nanoseconds.
+ */
+static uint64_t bench_now(void) {
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief Pins the calling thread to a CPU.
+ *
+ * \param[in] cpu CPU, or -1 to leave the thread unpinned.
+ */
+static void bench_pin(int cpu) {
+
+  if (cpu < 0) {
+    return;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  if (error != 0) {
+    fprintf(stderr, "[WARN] Failed to pin thread: %s\n", strerror(error));
+  }
+}
+
+/**
+ * \brief Pushes an item, spinning while the fifo is full.
+ *
+ * \param[in] fifo Fifo.
+ * \param[in] item Item.
+ */
+static void bench_push(hsi_fifo_t *fifo, const fifo_item_t *item) {
+
+  while (fifo_push(fifo, item) == FIFO_OVERRUN) {
+    sched_yield();
+  }
+}
+
+/**
+ * \brief Reads the next item, spinning while the fifo is empty.
+ *
+ * \param[in] fifo Fifo.
+ * \param[out] item Item.
+ * \param[in,out] consumed Whether the previous item was read.
+ */
+static void bench_pop(hsi_fifo_t *fifo, fifo_item_t *item, bool *consumed) {
+
+  int32_t status;
+  do {
+    status = *consumed ? fifo_next(fifo, item) : fifo_read(fifo, item);
+    if (status == FIFO_EMPTY) {
+      *consumed = false;
+      sched_yield();
+    } else if (status == FIFO_DATA) {
+      *consumed = true;
+    }
+  } while (status != FIFO_DATA);
+}
+
+/**
+ * \brief Consumer of the stream: checks that the items come in order.
+ *
+ * \param[in] argument Unused.
+ * \return NULL, or a non NULL value if an item is out of order.
+ */
+static void *bench_stream_consumer(void *argument) {
+
+  (void)argument;
+  bench_pin(bench_consumer_cpu);
+  hsi_fifo_t *fifo = fifo_get_pointer();
+  fifo_item_t item;
+  bool consumed = false;
+  for (uint32_t i = 0; i < BENCH_STREAM_ITEMS; i++) {
+    bench_pop(fifo, &item, &consumed);
+    if (item.lns_frame_count != i) {
+      return fifo;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * \brief Echoes the items of the forward fifo into the backward fifo.
+ *
+ * \param[in] argument Unused.
+ * \return NULL.
+ */
+static void *bench_echo(void *argument) {
+
+  (void)argument;
+  bench_pin(bench_consumer_cpu);
+  hsi_fifo_t *forward = fifo_get_pointer();
+  hsi_fifo_t *backward = fifo_backward_get_pointer();
+  fifo_item_t item;
+  bool consumed = false;
+  for (uint32_t i = 0; i < BENCH_ROUND_TRIPS; i++) {
+    bench_pop(forward, &item, &consumed);
+    bench_push(backward, &item);
+  }
+  return NULL;
+}
+
+/**
+ * \brief Compares two latencies, for qsort().
+ */
+static int bench_compare(const void *a, const void *b) {
+
+  uint64_t left = *(const uint64_t *)a;
+  uint64_t right = *(const uint64_t *)b;
+  return (left > right) - (left < right);
+}
+
+int main(int argc, char *argv[]) {
+
+  int producer_cpu = argc > 1 ? atoi(argv[1]) : -1;
+  bench_consumer_cpu = argc > 2 ? atoi(argv[2]) : -1;
+  bench_pin(producer_cpu);
+
+  // Throughput
+  hsi_fifo_t *forward = fifo_init();
+  hsi_fifo_t *backward = fifo_backward_init();
+  pthread_t consumer;
+  if (pthread_create(&consumer, NULL, bench_stream_consumer, NULL) != 0) {
+    perror("[ERROR] Failed to create consumer thread");
+    return EXIT_FAILURE;
+  }
+  fifo_item_t item;
+  memset(&item, 0, sizeof(item));
+  uint64_t start = bench_now();
+  for (uint32_t i = 0; i < BENCH_STREAM_ITEMS; i++) {
+    item.lns_frame_count = i;
+    bench_push(forward, &item);
+  }
+  void *failed;
+  pthread_join(consumer, &failed);
+  uint64_t elapsed = bench_now() - start;
+  if (failed != NULL) {
+    fprintf(stderr, "[ERROR] Items out of order\n");
+    return EXIT_FAILURE;
+  }
+  printf("[INFO] Throughput: %d items of %zu bytes in %.3f s, %.1f Mitems/s\n",
+         BENCH_STREAM_ITEMS, sizeof(fifo_item_t), (double)elapsed / 1e9,
+         BENCH_STREAM_ITEMS * 1e3 / (double)elapsed);
+
+  // Round trip latency
+  static uint64_t latencies[BENCH_ROUND_TRIPS];
+  forward = fifo_init();
+  backward = fifo_backward_init();
+  if (pthread_create(&consumer, NULL, bench_echo, NULL) != 0) {
+    perror("[ERROR] Failed to create echo thread");
+    return EXIT_FAILURE;
+  }
+  bool consumed = false;
+  for (uint32_t i = 0; i < BENCH_ROUND_TRIPS; i++) {
+    start = bench_now();
+    bench_push(forward, &item);
+    bench_pop(backward, &item, &consumed);
+    latencies[i] = bench_now() - start;
+  }
+  pthread_join(consumer, NULL);
+  qsort(latencies, BENCH_ROUND_TRIPS, sizeof(latencies[0]), bench_compare);
+  printf("[INFO] Round trip (ns): p50 %" PRIu64 ", p99 %" PRIu64
+         ", p99.9 %" PRIu64 ", max %" PRIu64 "\n",
+         latencies[BENCH_ROUND_TRIPS / 2],
+         latencies[BENCH_ROUND_TRIPS * 99 / 100],
+         latencies[BENCH_ROUND_TRIPS * 999 / 1000],
+         latencies[BENCH_ROUND_TRIPS - 1]);
+  return EXIT_SUCCESS;
+}
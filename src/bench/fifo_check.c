@@ -0,0 +1,125 @@
+/**
+ * \brief This file checks the overflow policies of the fifo between two
+ * threads: a producer pushes sequence numbers into a fifo of
+ * FIFO_CHECK_CAPACITY items, faster than the consumer reads them, and the
+ * consumer checks that the numbers delivered are increasing and that each
+ * number pushed is either delivered or counted as lost.
+ *
+ * Build with make bin/fifo_check. It exits with a failure if a policy loses
+ * or duplicates an item without counting it.
+ */
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fifo.h"
+
+#define FIFO_CHECK_CAPACITY 8
+#define FIFO_CHECK_ITEMS 200000
+// Items pushed or read before yielding, so that the two threads interleave
+// even on one CPU, the producer overflowing the fifo at each turn
+#define FIFO_CHECK_PUSH_BURST 12
+#define FIFO_CHECK_READ_BURST 5
+
+/**
+ * \brief Counts of a check, written by the consumer.
+ */
+typedef struct fifo_check_t {
+  hsi_fifo_t *fifo;
+  atomic_bool pushed;  // Whether the producer pushed all its items
+  uint64_t delivered;  // Items read
+  uint64_t lost;       // Items reported lost by FIFO_LOST
+  bool out_of_order;   // Whether an item came after a higher one
+} fifo_check_t;
+
+/**
+ * \brief Consumer of a check: reads the items until the producer is done and
+ * the fifo is empty, yielding regularly so that the fifo overflows.
+ *
+ * \param[in,out] argument Check.
+ * \return NULL.
+ */
+static void *fifo_check_consumer(void *argument) {
+
+  fifo_check_t *check = argument;
+  uint32_t item;
+  uint64_t next = 0; // Lowest sequence number expected
+  bool consumed = false;
+  for (;;) {
+    bool pushed = atomic_load(&check->pushed);
+    int32_t status = consumed ? fifo_next_data(check->fifo, &item)
+                              : fifo_read_data(check->fifo, &item);
+    // The item read by fifo_next_data() is released, even if it reports
+    // FIFO_LOST or FIFO_EMPTY
+    consumed = status == FIFO_DATA;
+    if (status == FIFO_DATA) {
+      check->out_of_order |= item < next;
+      next = (uint64_t)item + 1;
+      if (++check->delivered % FIFO_CHECK_READ_BURST == 0) {
+        sched_yield();
+      }
+    } else if (status == FIFO_LOST) {
+      check->lost += fifo_lost_count(check->fifo);
+    } else if (pushed) {
+      return NULL;
+    } else {
+      sched_yield();
+    }
+  }
+}
+
+/**
+ * \brief Pushes FIFO_CHECK_ITEMS sequence numbers into a fifo with a policy,
+ * and checks the items delivered and lost.
+ *
+ * \param[in] name Name of the policy, for the report.
+ * \param[in] policy Overflow policy.
+ * \return Whether every item pushed is either delivered or counted as lost.
+ */
+static bool fifo_check_policy(const char *name, uint32_t policy) {
+
+  static _Alignas(FIFO_ALIGNMENT) uint8_t memory[FIFO_MEMORY_SIZE(
+      sizeof(uint32_t), FIFO_CHECK_CAPACITY)];
+  fifo_check_t check = {
+      .fifo = fifo_create(memory, sizeof(memory), sizeof(uint32_t),
+                          FIFO_CHECK_CAPACITY, policy)};
+  atomic_init(&check.pushed, false);
+  pthread_t consumer;
+  if (check.fifo == NULL ||
+      pthread_create(&consumer, NULL, fifo_check_consumer, &check) != 0) {
+    perror("[ERROR] Failed to start the check");
+    return false;
+  }
+
+  uint64_t rejected = 0;
+  for (uint32_t i = 0; i < FIFO_CHECK_ITEMS; i++) {
+    rejected += fifo_push_data(check.fifo, &i) == FIFO_OVERRUN;
+    if ((i + 1) % FIFO_CHECK_PUSH_BURST == 0) {
+      sched_yield();
+    }
+  }
+  atomic_store(&check.pushed, true);
+  pthread_join(consumer, NULL);
+
+  bool passed = check.delivered + check.lost == FIFO_CHECK_ITEMS &&
+                check.lost == fifo_lost_total(check.fifo) &&
+                !check.out_of_order &&
+                (policy != FIFO_REJECT_NEWEST || rejected == check.lost) &&
+                (policy != FIFO_BLOCK || check.lost == 0);
+  printf("[%s] %s: %d pushed, %" PRIu64 " delivered, %" PRIu64 " lost\n",
+         passed ? "INFO" : "ERROR", name, FIFO_CHECK_ITEMS, check.delivered,
+         check.lost);
+  return passed;
+}
+
+int main(void) {
+
+  bool passed = fifo_check_policy("FIFO_REJECT_NEWEST", FIFO_REJECT_NEWEST);
+  passed &= fifo_check_policy("FIFO_OVERWRITE_OLDEST", FIFO_OVERWRITE_OLDEST);
+  passed &= fifo_check_policy("FIFO_BLOCK", FIFO_BLOCK);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+/**
+ * \brief This file benchmarks the state machines of a fleet of vehicles: the
+ * six compute_*_ctx() on the instance of each vehicle, against the six
+ * compute_*_batch() on the fleet store, and checks that both give the same
+ * states.
+ *
+ * Build with make bin/fleet_bench, and with
+ * OPTIMIZATION_FLAGS="-O2 -fno-tree-vectorize" to measure the batch functions
+ * without vectorization.
+ */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lib/data_dictionary.h"
+#include "src/state_machines/fsm_blinkers.h"
+#include "src/state_machines/fsm_lights.h"
+#include "src/state_machines/fsm_wipers.h"
+
+#define BENCH_VEHICLES 4096
+#define BENCH_ROUNDS 1000
+
+/**
+ * \brief Returns CLOCK_MONOTONIC.
+ *
+ * \return CLOCK_MONOTONIC, in nanoseconds.
+ */
+static uint64_t bench_now(void) {
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief Sets the commands of a vehicle, from the bits of its index, so that
+ * the vehicles of the fleet don't all take the same transitions.
+ *
+ * \param[out] ctx Application data of the vehicle.
+ * \param[in] vehicle Index of the vehicle.
+ */
+static void bench_commands(struct application_t *ctx, uint32_t vehicle) {
+
+  uint32_t bits = vehicle * 2654435761u; // Knuth's multiplicative hash
+  set_sidelights_in_ctx(ctx, bits & 0x1);
+  set_headlights_in_ctx(ctx, bits & 0x2);
+  set_redlights_in_ctx(ctx, bits & 0x4);
+  set_left_blinker_in_ctx(ctx, bits & 0x8);
+  set_right_blinker_in_ctx(ctx, bits & 0x10);
+  set_warnings_in_ctx(ctx, (bits & 0x3e0) == 0);
+  set_wipers_in_ctx(ctx, bits & 0x400);
+  set_washer_fluid_in_ctx(ctx, (bits & 0x3800) == 0);
+  set_headlights_acknowledgement_ctx(ctx, bits & 0x4000);
+  set_left_blinker_acknowledgement_ctx(ctx, bits & 0x8000);
+}
+
+/**
+ * \brief Checks that a vehicle of the fleet has the states and timers of its
+ * instance.
+ *
+ * \param[in] fleet Fleet store.
+ * \param[in] vehicle Index of the vehicle.
+ * \param[in] ctx Application data of the vehicle.
+ * \return Whether they are the same.
+ */
+static bool bench_same(const struct fleet_t *fleet, uint32_t vehicle,
+                       const struct application_t *ctx) {
+
+  static struct application_t loaded;
+  fleet_load_ctx(fleet, vehicle, &loaded);
+  return get_fsm_sidelights_ctx(&loaded) == get_fsm_sidelights_ctx(ctx) &&
+         get_fsm_headlights_ctx(&loaded) == get_fsm_headlights_ctx(ctx) &&
+         get_fsm_redlights_ctx(&loaded) == get_fsm_redlights_ctx(ctx) &&
+         get_fsm_left_blinker_ctx(&loaded) == get_fsm_left_blinker_ctx(ctx) &&
+         get_fsm_right_blinker_ctx(&loaded) ==
+             get_fsm_right_blinker_ctx(ctx) &&
+         get_fsm_wipers_ctx(&loaded) == get_fsm_wipers_ctx(ctx) &&
+         get_fsm_headlights_timer_ctx(&loaded) ==
+             get_fsm_headlights_timer_ctx(ctx) &&
+         get_fsm_left_blinker_timer_ctx(&loaded) ==
+             get_fsm_left_blinker_timer_ctx(ctx) &&
+         get_fsm_wipers_timer_ctx(&loaded) == get_fsm_wipers_timer_ctx(ctx);
+}
+
+int main(void) {
+
+  static struct application_t vehicles[BENCH_VEHICLES];
+  struct fleet_t fleet;
+  if (!fleet_init(&fleet, BENCH_VEHICLES)) {
+    perror("[ERROR] Failed to allocate fleet");
+    return EXIT_FAILURE;
+  }
+  for (uint32_t i = 0; i < BENCH_VEHICLES; i++) {
+    application_init_ctx(&vehicles[i]);
+    bench_commands(&vehicles[i], i);
+    fleet_store_ctx(&fleet, i, &vehicles[i]);
+  }
+
+  uint64_t start = bench_now();
+  for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+    for (uint32_t i = 0; i < BENCH_VEHICLES; i++) {
+      compute_sidelights_ctx(&vehicles[i]);
+      compute_headlights_ctx(&vehicles[i]);
+      compute_redlights_ctx(&vehicles[i]);
+      compute_left_blinker_ctx(&vehicles[i]);
+      compute_right_blinker_ctx(&vehicles[i]);
+      compute_wipers_ctx(&vehicles[i]);
+    }
+  }
+  uint64_t instances = bench_now() - start;
+
+  start = bench_now();
+  for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+    compute_sidelights_batch(&fleet);
+    compute_headlights_batch(&fleet);
+    compute_redlights_batch(&fleet);
+    compute_left_blinker_batch(&fleet);
+    compute_right_blinker_batch(&fleet);
+    compute_wipers_batch(&fleet);
+  }
+  uint64_t batch = bench_now() - start;
+
+  uint32_t differences = 0;
+  for (uint32_t i = 0; i < BENCH_VEHICLES; i++) {
+    differences += !bench_same(&fleet, i, &vehicles[i]);
+  }
+  fleet_free(&fleet);
+
+  double evaluations = (double)BENCH_VEHICLES * BENCH_ROUNDS;
+  printf("[INFO] %d vehicles, %d rounds of the six state machines\n",
+         BENCH_VEHICLES, BENCH_ROUNDS);
+  printf("[INFO] compute_*_ctx():   %.1f ns per vehicle\n",
+         (double)instances / evaluations);
+  printf("[INFO] compute_*_batch(): %.1f ns per vehicle\n",
+         (double)batch / evaluations);
+  if (differences != 0) {
+    fprintf(stderr, "[ERROR] %" PRIu32 " vehicles differ\n", differences);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+/**
+ * \brief This file implements the driver backend of drv_api.a and the lookup
+ * of the driver backends.
+ */
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include "driver.h"
+#include "drv_api_wire.h"
+
+#define DRV_API_MAX_FD 1024
+
+/**
+ * \brief Sockets of drv_api.a found by drv_api_channel_fd(), -1 until then.
+ */
+static int drv_api_channel_fds[] = {-1, -1};
+
+static uint64_t drv_api_cycles;
+static uint64_t drv_api_syscalls;
+static double drv_api_start_cpu_time;
+
+// The I/O syscalls of drv_api.a are counted by wrapping the functions it calls
+// (see the --wrap flags of the Makefile), as a reference for the other
+// backends talking to bin/driver
+
+int __real_select(int nfds, fd_set *readfds, fd_set *writefds,
+                  fd_set *exceptfds, struct timeval *timeout);
+ssize_t __real_recv(int socket, void *buffer, size_t size, int flags);
+ssize_t __real_send(int socket, const void *buffer, size_t size, int flags);
+
+int __wrap_select(int nfds, fd_set *readfds, fd_set *writefds,
+                  fd_set *exceptfds, struct timeval *timeout) {
+
+  drv_api_syscalls++;
+  return __real_select(nfds, readfds, writefds, exceptfds, timeout);
+}
+
+ssize_t __wrap_recv(int socket, void *buffer, size_t size, int flags) {
+
+  drv_api_syscalls++;
+  return __real_recv(socket, buffer, size, flags);
+}
+
+ssize_t __wrap_send(int socket, const void *buffer, size_t size, int flags) {
+
+  drv_api_syscalls++;
+  return __real_send(socket, buffer, size, flags);
+}
+
+double driver_cpu_time(void) {
+
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == -1) {
+    return 0.0;
+  }
+  return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+         (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int drv_api_socket(uint16_t port) {
+
+  for (int candidate = 0; candidate < DRV_API_MAX_FD; candidate++) {
+    struct sockaddr_in address;
+    socklen_t address_size = sizeof(address);
+    struct sockaddr *peer = (struct sockaddr *)&address;
+    if (getpeername(candidate, peer, &address_size) == 0 &&
+        address.sin_family == AF_INET && ntohs(address.sin_port) == port) {
+      return candidate;
+    }
+  }
+  errno = ENOTCONN;
+  return -1;
+}
+
+/**
+ * \brief Finds the socket of drv_api.a for an input channel.
+ *
+ * \param[in] fd File descriptor returned by drv_open().
+ * \param[in] channel Input channel.
+ * \return The socket, or -1 if it isn't found.
+ */
+static int drv_api_channel_fd(int32_t fd, driver_channel_t channel) {
+
+  (void)fd;
+  if (drv_api_channel_fds[channel] == -1) {
+    drv_api_channel_fds[channel] = drv_api_socket(
+        channel == DRIVER_CHANNEL_UDP_10MS ? DRV_API_UDP_PORT
+                                           : DRV_API_LNS_PORT);
+  }
+  return drv_api_channel_fds[channel];
+}
+
+/**
+ * \brief Reads the UDP 10ms frame waiting on the socket of drv_api.a.
+ * drv_read_udp_10ms() drops the frames already received and waits for the
+ * next one, which would skip every other frame once the socket is polled.
+ *
+ * \param[in] fd File descriptor returned by drv_open().
+ * \param[out] frame UDP 10ms frame.
+ * \return DRV_SUCCESS, or DRV_ERROR if the frame can't be read.
+ */
+static int32_t
+drv_api_read_udp_received(int32_t fd, uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  int socket = drv_api_channel_fd(fd, DRIVER_CHANNEL_UDP_10MS);
+  if (socket == -1) {
+    return DRV_ERROR;
+  }
+  struct drv_api_udp_message_t message;
+  ssize_t size = recv(socket, &message, sizeof(message), MSG_WAITALL);
+  if (size != sizeof(message)) {
+    if (size >= 0) {
+      errno = ECONNRESET; // bin/driver stopped
+    }
+    return DRV_ERROR;
+  }
+  memcpy(frame, message.frame, DRV_UDP_10MS_FRAME_SIZE);
+  drv_api_cycles++;
+  return DRV_SUCCESS;
+}
+
+static int32_t drv_api_open(void) {
+
+  drv_api_start_cpu_time = driver_cpu_time();
+  int32_t fd = drv_open();
+  drv_api_cycles = 0;
+  drv_api_syscalls = 0;
+  return fd;
+}
+
+static int32_t drv_api_read_udp_10ms(int32_t fd,
+                                     uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  int32_t status = drv_read_udp_10ms(fd, frame);
+  drv_api_cycles += status == DRV_SUCCESS;
+  return status;
+}
+
+static int32_t drv_api_close(int32_t fd) {
+
+  // Reference for the other backends talking to bin/driver
+  double cpu_time = driver_cpu_time() - drv_api_start_cpu_time;
+  if (fprintf(stderr,
+              "[INFO] drv_api driver served %" PRIu64
+              " cycles with %.2f syscalls/cycle and %.1f us of CPU/cycle\n",
+              drv_api_cycles,
+              drv_api_cycles != 0
+                  ? (double)drv_api_syscalls / (double)drv_api_cycles
+                  : 0.0,
+              drv_api_cycles != 0 ? cpu_time * 1e6 / (double)drv_api_cycles
+                                  : 0.0) < 0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+  return drv_close(fd);
+}
+
+// The other drv_api.a functions already have the signatures of the backend
+// functions
+const struct driver_t driver_drv_api = {
+    .name = "drv_api",
+    .open = drv_api_open,
+    .read_udp_10ms = drv_api_read_udp_10ms,
+    .write_udp_20ms = drv_write_udp_20ms,
+    .read_lns = drv_read_lns,
+    .write_lns = drv_write_lns,
+    .close = drv_api_close,
+    .channel_fd = drv_api_channel_fd,
+    .read_udp_received = drv_api_read_udp_received,
+};
+
+/**
+ * \brief Available driver backends.
+ */
+static const struct driver_t *const drivers[] = {
+    &driver_drv_api, &driver_uring, &driver_mock, &driver_replay};
+
+const struct driver_t *driver_find(const char *name) {
+
+  for (size_t i = 0; i < sizeof(drivers) / sizeof(drivers[0]); i++) {
+    if (strcmp(drivers[i]->name, name) == 0) {
+      return drivers[i];
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,139 @@
+/**
+ * \brief This file defines the interface of the driver backends, through which
+ * the application reads and writes its frames, and the available backends.
+ */
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib/drv_api.h"
+
+/**
+ * \brief Input channels of a driver.
+ */
+typedef enum driver_channel_t {
+  DRIVER_CHANNEL_UDP_10MS = 0,
+  DRIVER_CHANNEL_LNS = 1
+} driver_channel_t;
+
+/**
+ * \brief Driver backend: the functions of drv_api.h, behind pointers so that
+ * the application can run on another backend than bin/driver.
+ *
+ * channel_fd and read_udp_received, which may be NULL, serve the event loop:
+ * channel_fd returns a file descriptor that can be polled for the frames of an
+ * input channel, or -1 if there is none (errno is set), and read_udp_received
+ * reads the UDP 10ms frame that made its channel readable, whereas
+ * read_udp_10ms may drop it and wait for the next one.
+ */
+struct driver_t {
+  const char *name;
+  int32_t (*open)(void);
+  int32_t (*read_udp_10ms)(int32_t fd,
+                           uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]);
+  int32_t (*write_udp_20ms)(int32_t fd,
+                            uint8_t frame[DRV_UDP_20MS_FRAME_SIZE]);
+  int32_t (*read_lns)(int32_t fd, lns_frame_t frames[DRV_MAX_FRAMES],
+                      uint32_t *frame_count);
+  int32_t (*write_lns)(int32_t fd, lns_frame_t *frames, uint32_t frame_count);
+  int32_t (*close)(int32_t fd);
+  int (*channel_fd)(int32_t fd, driver_channel_t channel);
+  int32_t (*read_udp_received)(int32_t fd,
+                               uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]);
+};
+
+/**
+ * \brief Backend of drv_api.a, talking to the bin/driver process.
+ */
+extern const struct driver_t driver_drv_api;
+
+/**
+ * \brief Backend talking to bin/driver through the sockets of drv_api.a with
+ * io_uring, submitting the I/O of a cycle in a single syscall.
+ */
+extern const struct driver_t driver_uring;
+
+/**
+ * \brief In-process backend serving scripted frames from memory, as fast as
+ * they are read (see mock_driver_configure()).
+ */
+extern const struct driver_t driver_mock;
+
+/**
+ * \brief In-process backend serving the frames of a frame log (see
+ * driver_replay_configure()).
+ */
+extern const struct driver_t driver_replay;
+
+/**
+ * \brief Backend recording the frames exchanged with another backend into a
+ * frame log (see driver_recorder_configure()).
+ */
+extern const struct driver_t driver_recorder;
+
+/**
+ * \brief Finds a driver backend by name.
+ *
+ * \param[in] name Name of the backend ("drv_api", "uring", "mock" or
+ * "replay").
+ * \return The backend, or NULL if there is no backend of that name.
+ */
+const struct driver_t *driver_find(const char *name);
+
+/**
+ * \brief Returns the CPU time used by the process, for the reports of the
+ * backends.
+ *
+ * \return User and system CPU time, in seconds.
+ */
+double driver_cpu_time(void);
+
+/**
+ * \brief Frames read by the application during one cycle of the mock driver.
+ */
+struct mock_cycle_t {
+  uint8_t udp_frame[DRV_UDP_10MS_FRAME_SIZE];
+  lns_frame_t lns_frames[DRV_MAX_FRAMES];
+  uint32_t lns_frame_count;
+};
+
+/**
+ * \brief Configures the mock driver, before it is opened.
+ *
+ * \param[in] script Cycles served in a loop, or NULL for the built-in script
+ * (MUX frames with consecutive IDs, commodos commands going through every FSM
+ * and BGF acknowledgements).
+ * \param[in] script_length Number of cycles of the script.
+ * \param[in] cycle_count Number of cycles served before reads fail, ending
+ * the main loop, 0 for no limit.
+ */
+void mock_driver_configure(const struct mock_cycle_t *script,
+                           size_t script_length, uint64_t cycle_count);
+
+/**
+ * \brief Configures the recorder driver, before it is opened.
+ *
+ * \param[in] inner Backend whose frames are recorded.
+ * \param[in] path Path of the frame log, created or truncated when the driver
+ * is opened.
+ * \return The recorder backend to use: driver_recorder if inner can be polled,
+ * a recorder without channel_fd and read_udp_received otherwise.
+ */
+const struct driver_t *driver_recorder_configure(const struct driver_t *inner,
+                                                 const char *path);
+
+/**
+ * \brief Configures the replay driver, before it is opened. The frames written
+ * by the application are compared with the recorded ones, and the number of
+ * differences is reported when the driver is closed.
+ *
+ * \param[in] path Path of the frame log.
+ * \param[in] real_time Whether the UDP 10ms frames are served with their
+ * recorded timing, or as fast as they are read.
+ */
+void driver_replay_configure(const char *path, bool real_time);
+
+#endif // DRIVER_H
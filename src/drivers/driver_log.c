@@ -0,0 +1,437 @@
+/**
+ * \brief This file implements the recorder driver backend, logging the frames
+ * exchanged with another backend into a frame log, and the replay driver
+ * backend, serving the frames of a frame log.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "driver.h"
+#include "frame_log.h"
+
+#define REPLAY_DRIVER_FD 0x5250
+// Cycles an output may be recorded after the inputs of its cycle, above the
+// FIFO_MAX_ITEMS / 3 cycles read ahead of the outputs by the threaded loop
+#define REPLAY_OUTPUT_LAG_CYCLES 256
+
+static const struct driver_t *recorder_inner = NULL;
+static const char *recorder_path = NULL;
+static struct frame_log_t recorder_log;
+static bool recorder_failed;
+
+static const char *replay_path = NULL;
+static bool replay_real_time = false;
+static struct frame_log_t replay_log;
+static struct timespec replay_start;
+static uint64_t replay_first_timestamp;
+static uint64_t replay_cycle;
+static uint64_t replay_mismatches;
+// Offset of the next recorded output to compare, which lags behind the inputs
+// when the application writes its outputs after reading the next cycle
+static uint64_t replay_output_cursor;
+// Offset of the next recorded LNS input, which lags behind the cycles when
+// the LNS frames of a cycle don't fit in one read
+static uint64_t replay_lns_cursor;
+
+// Backend without the polling functions, for the backends that have none
+static const struct driver_t driver_recorder_unpolled;
+
+const struct driver_t *driver_recorder_configure(const struct driver_t *inner,
+                                                 const char *path) {
+
+  recorder_inner = inner;
+  recorder_path = path;
+  return inner->channel_fd != NULL && inner->read_udp_received != NULL
+             ? &driver_recorder
+             : &driver_recorder_unpolled;
+}
+
+/**
+ * \brief Appends an entry to the recorded log. Recording stops at the first
+ * failure, without stopping the application.
+ *
+ * \param[in] type_p Type of the entry.
+ * \param[in] udp_frame_p UDP frame, for the UDP entries.
+ * \param[in] udp_frame_size_p Size of the UDP frame.
+ * \param[in] lns_frames_p LNS frames, for the LNS entries.
+ * \param[in] lns_frame_count_p Number of LNS frames.
+ */
+static void recorder_append(frame_log_entry_type_t type_p,
+                            const uint8_t *udp_frame_p, size_t udp_frame_size_p,
+                            const lns_frame_t *lns_frames_p,
+                            uint32_t lns_frame_count_p) {
+
+  if (recorder_failed) {
+    return;
+  }
+  if (!frame_log_append(&recorder_log, type_p, udp_frame_p, udp_frame_size_p,
+                        lns_frames_p, lns_frame_count_p)) {
+    perror("[WARN] Failed to record frames, recording stopped");
+    recorder_failed = true;
+  }
+}
+
+static int32_t recorder_open(void) {
+
+  if (!frame_log_create(&recorder_log, recorder_path)) {
+    return DRV_ERROR;
+  }
+  recorder_failed = false;
+  int32_t fd = recorder_inner->open();
+  if (fd == DRV_ERROR) {
+    int error = errno;
+    frame_log_close(&recorder_log);
+    errno = error;
+  }
+  return fd;
+}
+
+static int32_t recorder_read_udp_10ms(int32_t fd,
+                                      uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  int32_t status = recorder_inner->read_udp_10ms(fd, frame);
+  if (status == DRV_SUCCESS) {
+    recorder_append(FRAME_LOG_UDP_IN, frame, DRV_UDP_10MS_FRAME_SIZE, NULL, 0);
+  }
+  return status;
+}
+
+static int32_t recorder_write_udp_20ms(int32_t fd,
+                                       uint8_t frame[DRV_UDP_20MS_FRAME_SIZE]) {
+
+  recorder_append(FRAME_LOG_UDP_OUT, frame, DRV_UDP_20MS_FRAME_SIZE, NULL, 0);
+  return recorder_inner->write_udp_20ms(fd, frame);
+}
+
+static int32_t recorder_read_lns(int32_t fd, lns_frame_t frames[DRV_MAX_FRAMES],
+                                 uint32_t *frame_count) {
+
+  int32_t status = recorder_inner->read_lns(fd, frames, frame_count);
+  if (status == DRV_SUCCESS) {
+    recorder_append(FRAME_LOG_LNS_IN, NULL, 0, frames, *frame_count);
+  }
+  return status;
+}
+
+static int32_t recorder_write_lns(int32_t fd, lns_frame_t *frames,
+                                  uint32_t frame_count) {
+
+  recorder_append(FRAME_LOG_LNS_OUT, NULL, 0, frames, frame_count);
+  return recorder_inner->write_lns(fd, frames, frame_count);
+}
+
+static int recorder_channel_fd(int32_t fd, driver_channel_t channel) {
+
+  return recorder_inner->channel_fd(fd, channel);
+}
+
+static int32_t recorder_read_udp_received(
+    int32_t fd, uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  int32_t status = recorder_inner->read_udp_received(fd, frame);
+  if (status == DRV_SUCCESS) {
+    recorder_append(FRAME_LOG_UDP_IN, frame, DRV_UDP_10MS_FRAME_SIZE, NULL, 0);
+  }
+  return status;
+}
+
+static int32_t recorder_close(int32_t fd) {
+
+  if (!frame_log_close(&recorder_log)) {
+    perror("[WARN] Failed to write the recorded frames");
+  }
+  return recorder_inner->close(fd);
+}
+
+const struct driver_t driver_recorder = {
+    .name = "recorder",
+    .open = recorder_open,
+    .read_udp_10ms = recorder_read_udp_10ms,
+    .write_udp_20ms = recorder_write_udp_20ms,
+    .read_lns = recorder_read_lns,
+    .write_lns = recorder_write_lns,
+    .close = recorder_close,
+    .channel_fd = recorder_channel_fd,
+    .read_udp_received = recorder_read_udp_received,
+};
+
+static const struct driver_t driver_recorder_unpolled = {
+    .name = "recorder",
+    .open = recorder_open,
+    .read_udp_10ms = recorder_read_udp_10ms,
+    .write_udp_20ms = recorder_write_udp_20ms,
+    .read_lns = recorder_read_lns,
+    .write_lns = recorder_write_lns,
+    .close = recorder_close,
+    .channel_fd = NULL, // Not polled, as the backend recorded
+    .read_udp_received = NULL,
+};
+
+void driver_replay_configure(const char *path, bool real_time) {
+
+  replay_path = path;
+  replay_real_time = real_time;
+}
+
+/**
+ * \brief Checks whether an entry is an output of the application.
+ *
+ * \param[in] entry_p Entry.
+ * \return Whether the entry is a frame written by the application.
+ */
+static bool replay_is_output(const struct frame_log_entry_t *entry_p) {
+
+  return entry_p->type == FRAME_LOG_UDP_OUT ||
+         entry_p->type == FRAME_LOG_LNS_OUT;
+}
+
+/**
+ * \brief Returns the offset of the end of the cycles read from the replayed
+ * log: the offset of the next cycle.
+ *
+ * \return The offset, UINT64_MAX if the last cycle is read.
+ */
+static uint64_t replay_cycles_end(void) {
+
+  return replay_cycle < replay_log.cycle_count ? replay_log.index[replay_cycle]
+                                               : UINT64_MAX;
+}
+
+/**
+ * \brief Reads the next recorded output, up to REPLAY_OUTPUT_LAG_CYCLES cycles
+ * after the last cycle read, and moves the output cursor after it.
+ *
+ * \return The entry, or NULL if there is no more output in these cycles.
+ */
+static const struct frame_log_entry_t *replay_next_output(void) {
+
+  uint64_t input_cursor = replay_log.cursor;
+  uint32_t cycles_ahead = 0;
+  const struct frame_log_entry_t *output = NULL;
+  const struct frame_log_entry_t *entry;
+
+  // Outputs can't be written before the inputs of their cycle are read, but
+  // can be recorded after the inputs of the next cycles
+  replay_log.cursor = replay_output_cursor;
+  while (output == NULL && (entry = frame_log_peek(&replay_log)) != NULL &&
+         (entry->type != FRAME_LOG_UDP_IN ||
+          replay_log.cursor < input_cursor ||
+          cycles_ahead++ < REPLAY_OUTPUT_LAG_CYCLES)) {
+    frame_log_next(&replay_log);
+    if (replay_is_output(entry)) {
+      output = entry;
+    }
+  }
+  replay_output_cursor = replay_log.cursor;
+  replay_log.cursor = input_cursor;
+  return output;
+}
+
+/**
+ * \brief Finds the next recorded output of a type, and moves the output cursor
+ * after it. The recorded outputs skipped on the way weren't written by the
+ * application, and are counted as mismatches.
+ *
+ * \param[in] type_p Type of the entry.
+ * \return The entry, or NULL if the cycles read have no more output of that
+ * type.
+ */
+static const struct frame_log_entry_t *
+replay_find_output(frame_log_entry_type_t type_p) {
+
+  uint64_t cursor = replay_output_cursor;
+  uint64_t skipped = 0;
+  const struct frame_log_entry_t *entry;
+
+  while ((entry = replay_next_output()) != NULL && entry->type != type_p) {
+    skipped++;
+  }
+  if (entry == NULL) {
+    // An output that wasn't recorded leaves the recorded ones to the next
+    replay_output_cursor = cursor;
+  } else {
+    replay_mismatches += skipped;
+  }
+  return entry;
+}
+
+static int32_t replay_open(void) {
+
+  if (replay_path == NULL) {
+    errno = EINVAL;
+    return DRV_ERROR;
+  }
+  if (!frame_log_open(&replay_log, replay_path)) {
+    return DRV_ERROR;
+  }
+  replay_cycle = 0;
+  replay_mismatches = 0;
+  replay_output_cursor = 0;
+  replay_lns_cursor = 0;
+  if (frame_log_seek(&replay_log, 0)) {
+    replay_first_timestamp = frame_log_peek(&replay_log)->timestamp;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &replay_start);
+  return REPLAY_DRIVER_FD;
+}
+
+static int32_t replay_read_udp_10ms(int32_t fd,
+                                    uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  if (fd != REPLAY_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // The entries left in the previous cycle are read through their own cursors
+  const struct frame_log_entry_t *entry =
+      frame_log_seek(&replay_log, replay_cycle) ? frame_log_next(&replay_log)
+                                                : NULL;
+  if (entry == NULL) {
+    errno = ENODATA; // End of the log
+    return DRV_ERROR;
+  }
+
+  if (replay_real_time) {
+    // Wait until the frame is due, as recorded relatively to the first one
+    uint64_t delay = entry->timestamp - replay_first_timestamp;
+    struct timespec due = {
+        .tv_sec = replay_start.tv_sec + (time_t)(delay / 1000000000u),
+        .tv_nsec = replay_start.tv_nsec + (long)(delay % 1000000000u)};
+    if (due.tv_nsec >= 1000000000) {
+      due.tv_sec++;
+      due.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) ==
+           EINTR) {
+    }
+  }
+
+  memcpy(frame, entry->payload,
+         entry->size < DRV_UDP_10MS_FRAME_SIZE ? entry->size
+                                               : DRV_UDP_10MS_FRAME_SIZE);
+  replay_cycle++;
+  return DRV_SUCCESS;
+}
+
+static int32_t replay_write_udp_20ms(int32_t fd,
+                                     uint8_t frame[DRV_UDP_20MS_FRAME_SIZE]) {
+
+  if (fd != REPLAY_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // Regression check against the recorded output
+  const struct frame_log_entry_t *entry = replay_find_output(FRAME_LOG_UDP_OUT);
+  if (entry == NULL || entry->size != DRV_UDP_20MS_FRAME_SIZE ||
+      memcmp(entry->payload, frame, DRV_UDP_20MS_FRAME_SIZE) != 0) {
+    replay_mismatches++;
+  }
+  return DRV_SUCCESS;
+}
+
+static int32_t replay_read_lns(int32_t fd, lns_frame_t frames[DRV_MAX_FRAMES],
+                               uint32_t *frame_count) {
+
+  if (fd != REPLAY_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // The event loop records a batch per LNS read, several per cycle: the
+  // batches of the cycles read are merged, and those that don't fit are left
+  // to the next read
+  uint64_t input_cursor = replay_log.cursor;
+  uint64_t cycles_end = replay_cycles_end();
+  const struct frame_log_entry_t *entry;
+  *frame_count = 0;
+  replay_log.cursor = replay_lns_cursor;
+  while (replay_log.cursor < cycles_end &&
+         (entry = frame_log_peek(&replay_log)) != NULL) {
+    if (entry->type == FRAME_LOG_LNS_IN) {
+      uint32_t count = entry->count;
+      if (count > entry->size / sizeof(struct frame_log_lns_frame_t)) {
+        count = entry->size / sizeof(struct frame_log_lns_frame_t);
+      }
+      if (*frame_count + count > DRV_MAX_FRAMES) {
+        if (*frame_count != 0) {
+          break;
+        }
+        count = DRV_MAX_FRAMES; // More than a read returns, truncated
+      }
+      const struct frame_log_lns_frame_t *logged =
+          (const struct frame_log_lns_frame_t *)entry->payload;
+      for (uint32_t i = 0; i < count; i++) {
+        lns_frame_t *frame = &frames[(*frame_count)++];
+        frame->serNum = logged[i].serial_number;
+        frame->frameSize = logged[i].size;
+        memcpy(frame->frame, logged[i].frame, LNS_MAX_FRAME_SIZE);
+      }
+    }
+    frame_log_next(&replay_log);
+  }
+  replay_lns_cursor = replay_log.cursor;
+  replay_log.cursor = input_cursor;
+  return DRV_SUCCESS;
+}
+
+static int32_t replay_write_lns(int32_t fd, lns_frame_t *frames,
+                                uint32_t frame_count) {
+
+  if (fd != REPLAY_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // Regression check against the recorded output
+  const struct frame_log_entry_t *entry = replay_find_output(FRAME_LOG_LNS_OUT);
+  bool match = entry != NULL && entry->count == frame_count;
+  const struct frame_log_lns_frame_t *logged =
+      match ? (const struct frame_log_lns_frame_t *)entry->payload : NULL;
+  for (uint32_t i = 0; match && i < frame_count; i++) {
+    match = logged[i].serial_number == frames[i].serNum &&
+            logged[i].size == (uint8_t)frames[i].frameSize &&
+            memcmp(logged[i].frame, frames[i].frame, LNS_MAX_FRAME_SIZE) == 0;
+  }
+  if (!match) {
+    replay_mismatches++;
+  }
+  return DRV_SUCCESS;
+}
+
+static int32_t replay_close(int32_t fd) {
+
+  if (fd != REPLAY_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // Recorded outputs of the cycles replayed that were never written
+  while (replay_next_output() != NULL) {
+    replay_mismatches++;
+  }
+  if (fprintf(stderr,
+              "[INFO] Replayed %" PRIu64 " of %" PRIu64 " cycles, %" PRIu64
+              " outputs differ from the log\n",
+              replay_cycle, replay_log.cycle_count, replay_mismatches) < 0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+  frame_log_close(&replay_log);
+  return DRV_SUCCESS;
+}
+
+const struct driver_t driver_replay = {
+    .name = "replay",
+    .open = replay_open,
+    .read_udp_10ms = replay_read_udp_10ms,
+    .write_udp_20ms = replay_write_udp_20ms,
+    .read_lns = replay_read_lns,
+    .write_lns = replay_write_lns,
+    .close = replay_close,
+    .channel_fd = NULL, // Frames are always ready
+    .read_udp_received = NULL,
+};
@@ -0,0 +1,223 @@
+/**
+ * \brief This file implements the mock driver backend, serving scripted frames
+ * from memory so that the application can be run and timed without bin/driver.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "driver.h"
+#include "lib/checksum.h"
+
+#define MOCK_DRIVER_FD 0x4d4f
+#define MOCK_SCRIPT_LENGTH 400
+#define MOCK_MUX_ID_MAX 100
+
+#define COMMODOS_SERIAL_NUMBER 12
+#define BGF_SERIAL_NUMBER 11
+#define BGF_FRAME_COUNT 5
+
+/**
+ * \brief Commodos commands, as encoded in the commands byte (see frames.csv).
+ */
+typedef enum mock_commodos_command_t {
+  MOCK_WASHER_FLUID = 0x01,
+  MOCK_WIPERS = 0x02,
+  MOCK_LEFT_BLINKER = 0x04,
+  MOCK_RIGHT_BLINKER = 0x08,
+  MOCK_REDLIGHTS = 0x10,
+  MOCK_HEADLIGHTS = 0x20,
+  MOCK_SIDELIGHTS = 0x40,
+  MOCK_WARNINGS = 0x80
+} mock_commodos_command_t;
+
+/**
+ * \brief Commands of each quarter of the built-in script, so that every FSM
+ * goes through its states.
+ */
+static const uint8_t mock_commands[] = {
+    MOCK_SIDELIGHTS | MOCK_HEADLIGHTS,
+    MOCK_SIDELIGHTS | MOCK_REDLIGHTS | MOCK_LEFT_BLINKER,
+    MOCK_WIPERS | MOCK_RIGHT_BLINKER,
+    MOCK_WARNINGS | MOCK_WASHER_FLUID,
+};
+
+static struct mock_cycle_t mock_builtin_script[MOCK_SCRIPT_LENGTH];
+
+static const struct mock_cycle_t *mock_script = NULL;
+static size_t mock_script_length = 0;
+static uint64_t mock_cycle_limit = 0;
+
+// Runtime state, reset when the driver is opened
+static uint64_t mock_cycle;
+static size_t mock_index;
+static const struct mock_cycle_t *mock_current;
+static struct timespec mock_start;
+
+/**
+ * \brief Writes a 32 bits value in big endian into a frame.
+ *
+ * \param[out] frame_p First byte of the value in the frame.
+ * \param[in] value_p Value to write.
+ */
+static void mock_write_be32(uint8_t *frame_p, uint32_t value_p) {
+
+  frame_p[0] = (uint8_t)(value_p >> 24);
+  frame_p[1] = (uint8_t)(value_p >> 16);
+  frame_p[2] = (uint8_t)(value_p >> 8);
+  frame_p[3] = (uint8_t)value_p;
+}
+
+/**
+ * \brief Fills the built-in script.
+ */
+static void mock_build_script(void) {
+
+  for (size_t i = 0; i < MOCK_SCRIPT_LENGTH; i++) {
+    struct mock_cycle_t *cycle = &mock_builtin_script[i];
+
+    // MUX frame (see frames.csv), with consecutive IDs and a draining tank
+    cycle->udp_frame[0] = (uint8_t)(i % MOCK_MUX_ID_MAX + 1);
+    mock_write_be32(&cycle->udp_frame[1], 12000 + (uint32_t)i / 40);
+    cycle->udp_frame[5] = (uint8_t)(50 + i % 40);
+    cycle->udp_frame[6] = 0;
+    cycle->udp_frame[7] = 0;
+    cycle->udp_frame[8] = (uint8_t)(40 - i / 10);
+    mock_write_be32(&cycle->udp_frame[9], 2000 + 10 * (uint32_t)(i % 100));
+    cycle->udp_frame[13] = 0;
+
+    // Commodos frame: CRC8 of the commands byte, then the commands byte
+    lns_frame_t *commodos = &cycle->lns_frames[0];
+    commodos->serNum = COMMODOS_SERIAL_NUMBER;
+    commodos->frame[1] = mock_commands[i * 4 / MOCK_SCRIPT_LENGTH];
+    commodos->frame[0] = crc_8(&commodos->frame[1], 1);
+    commodos->frameSize = LNS_MAX_FRAME_SIZE;
+
+    // BGF acknowledgements of the five BGF frames
+    for (uint8_t bgf = 0; bgf < BGF_FRAME_COUNT; bgf++) {
+      lns_frame_t *acknowledgement = &cycle->lns_frames[1 + bgf];
+      acknowledgement->serNum = BGF_SERIAL_NUMBER;
+      acknowledgement->frame[0] = bgf + 1;
+      acknowledgement->frame[1] = 1;
+      acknowledgement->frameSize = LNS_MAX_FRAME_SIZE;
+    }
+    cycle->lns_frame_count = 1 + BGF_FRAME_COUNT;
+  }
+}
+
+void mock_driver_configure(const struct mock_cycle_t *script,
+                           size_t script_length, uint64_t cycle_count) {
+
+  mock_script = script;
+  mock_script_length = script_length;
+  mock_cycle_limit = cycle_count;
+}
+
+static int32_t mock_open(void) {
+
+  if (mock_script == NULL || mock_script_length == 0) {
+    mock_build_script();
+    mock_script = mock_builtin_script;
+    mock_script_length = MOCK_SCRIPT_LENGTH;
+  }
+  mock_cycle = 0;
+  mock_index = 0;
+  mock_current = &mock_script[0];
+  clock_gettime(CLOCK_MONOTONIC, &mock_start);
+  return MOCK_DRIVER_FD;
+}
+
+static int32_t mock_read_udp_10ms(int32_t fd,
+                                  uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  if (fd != MOCK_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+  if (mock_cycle_limit != 0 && mock_cycle == mock_cycle_limit) {
+    errno = ENODATA; // End of the run
+    return DRV_ERROR;
+  }
+
+  mock_current = &mock_script[mock_index];
+  if (++mock_index == mock_script_length) {
+    mock_index = 0;
+  }
+  mock_cycle++;
+
+  memcpy(frame, mock_current->udp_frame, DRV_UDP_10MS_FRAME_SIZE);
+  return DRV_SUCCESS;
+}
+
+static int32_t mock_write_udp_20ms(int32_t fd,
+                                   uint8_t frame[DRV_UDP_20MS_FRAME_SIZE]) {
+
+  (void)frame;
+  if (fd != MOCK_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+  return DRV_SUCCESS;
+}
+
+static int32_t mock_read_lns(int32_t fd, lns_frame_t frames[DRV_MAX_FRAMES],
+                             uint32_t *frame_count) {
+
+  if (fd != MOCK_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // LNS frames of the cycle of the last UDP frame read
+  memcpy(frames, mock_current->lns_frames,
+         mock_current->lns_frame_count * sizeof(lns_frame_t));
+  *frame_count = mock_current->lns_frame_count;
+  return DRV_SUCCESS;
+}
+
+static int32_t mock_write_lns(int32_t fd, lns_frame_t *frames,
+                              uint32_t frame_count) {
+
+  (void)frames;
+  if (fd != MOCK_DRIVER_FD || frame_count > DRV_MAX_FRAMES) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+  return DRV_SUCCESS;
+}
+
+static int32_t mock_close(int32_t fd) {
+
+  if (fd != MOCK_DRIVER_FD) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double elapsed = (double)(end.tv_sec - mock_start.tv_sec) +
+                   (double)(end.tv_nsec - mock_start.tv_nsec) / 1e9;
+  if (fprintf(stderr,
+              "[INFO] Mock driver served %" PRIu64 " cycles in %.3f s"
+              " (%.1f ns/cycle)\n",
+              mock_cycle, elapsed,
+              mock_cycle != 0 ? elapsed * 1e9 / (double)mock_cycle : 0.0) <
+      0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+  return DRV_SUCCESS;
+}
+
+const struct driver_t driver_mock = {
+    .name = "mock",
+    .open = mock_open,
+    .read_udp_10ms = mock_read_udp_10ms,
+    .write_udp_20ms = mock_write_udp_20ms,
+    .read_lns = mock_read_lns,
+    .write_lns = mock_write_lns,
+    .close = mock_close,
+    .channel_fd = NULL, // Frames are always ready
+    .read_udp_received = NULL,
+};
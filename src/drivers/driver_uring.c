@@ -0,0 +1,605 @@
+/**
+ * \brief This file implements the io_uring driver backend, talking to
+ * bin/driver through the sockets of drv_api.a with batched I/O.
+ *
+ * drv_api.a issues at least five syscalls per cycle, as counted by the drv_api
+ * backend: select() and recv() for the UDP 10ms frame, select() for the LNS
+ * frames, and send() for each of the two writes. This backend queues the
+ * writes of a cycle and the receives that have completed, and submits them in
+ * the io_uring_enter() call that waits for the next UDP 10ms frame: one
+ * syscall per cycle. The messages are received and sent from registered
+ * buffers, through registered sockets.
+ *
+ * The UDP 20ms and LNS frames are sent on the same socket: their messages are
+ * appended to a single buffer, sent in order by one write at a time, and a
+ * short write is followed by a write of the rest.
+ *
+ * Unlike drv_read_udp_10ms(), which drops the frames received meanwhile and
+ * waits for the next one, read_udp_10ms() returns the UDP 10ms frames in the
+ * order they were received. A failed write is reported by the next write, and
+ * the messages not sent yet are dropped.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "driver.h"
+#include "drv_api_wire.h"
+
+#define URING_ENTRIES 8
+#define URING_STREAM_MESSAGES 16
+
+/**
+ * \brief Operations of the ring, also the indexes of their registered buffers.
+ * There is at most one operation of each kind in flight.
+ */
+typedef enum uring_operation_t {
+  URING_UDP_IN = 0,
+  URING_LNS_IN = 1,
+  URING_TX = 2,
+  URING_OPERATION_COUNT = 3
+} uring_operation_t;
+
+/**
+ * \brief Indexes of the registered sockets.
+ */
+typedef enum uring_file_t {
+  URING_FILE_UDP = 0,
+  URING_FILE_LNS = 1,
+  URING_FILE_TX = 2,
+  URING_FILE_COUNT = 3
+} uring_file_t;
+
+/**
+ * \brief Messages received from a socket of bin/driver into a registered
+ * buffer. TCP being a byte stream, a receive may end in the middle of a
+ * message, which the next receive completes.
+ */
+struct uring_stream_t {
+  uint8_t *buffer;
+  size_t capacity;
+  size_t start; // First byte not read by the application
+  size_t end;   // Last byte received
+  size_t message_size;
+};
+
+/**
+ * \brief Messages sent to bin/driver from a registered buffer.
+ */
+struct uring_output_t {
+  size_t start; // First byte not sent
+  size_t end;   // End of the messages written by the application
+};
+
+/**
+ * \brief Registered buffers, in the order of uring_operation_t.
+ */
+static struct {
+  uint8_t udp_in[URING_STREAM_MESSAGES * sizeof(struct drv_api_udp_message_t)];
+  uint8_t lns_in[URING_STREAM_MESSAGES * sizeof(struct drv_api_message_t)];
+  uint8_t tx[URING_STREAM_MESSAGES * sizeof(struct drv_api_message_t)];
+} uring_buffers __attribute__((aligned(64)));
+
+/**
+ * \brief Ring shared with the kernel.
+ */
+static struct {
+  int fd;
+  void *sq_ring;
+  size_t sq_ring_size;
+  void *cq_ring;
+  size_t cq_ring_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+  unsigned queued; // Operations not submitted yet
+} uring = {.fd = -1};
+
+// Runtime state, reset when the driver is opened
+static int32_t uring_driver_fd = DRV_ERROR;
+static struct uring_stream_t uring_streams[URING_LNS_IN + 1];
+static struct uring_output_t uring_output;
+static bool uring_in_flight[URING_OPERATION_COUNT];
+static int uring_errors[URING_OPERATION_COUNT]; // errno of a failed operation
+static uint64_t uring_cycles;
+static uint64_t uring_syscalls;
+static double uring_start_cpu_time;
+
+/**
+ * \brief Releases the ring.
+ */
+static void uring_destroy(void) {
+
+  if (uring.sqes != NULL) {
+    munmap(uring.sqes, uring.sqes_size);
+  }
+  if (uring.cq_ring != NULL && uring.cq_ring != uring.sq_ring) {
+    munmap(uring.cq_ring, uring.cq_ring_size);
+  }
+  if (uring.sq_ring != NULL) {
+    munmap(uring.sq_ring, uring.sq_ring_size);
+  }
+  if (uring.fd != -1) {
+    close(uring.fd);
+  }
+  memset(&uring, 0, sizeof(uring));
+  uring.fd = -1;
+}
+
+/**
+ * \brief Creates the ring, and registers the buffers and the sockets.
+ *
+ * \param[in] files Sockets, in the order of uring_file_t.
+ * \return Whether the ring is created (errno is set otherwise).
+ */
+static bool uring_create(const int files[URING_FILE_COUNT]) {
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  uring.fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+  if (uring.fd == -1) {
+    return false;
+  }
+
+  uring.sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  uring.cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (uring.cq_ring_size > uring.sq_ring_size) {
+      uring.sq_ring_size = uring.cq_ring_size;
+    }
+  }
+  uring.sq_ring = mmap(NULL, uring.sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQ_RING);
+  if (uring.sq_ring == MAP_FAILED) {
+    uring.sq_ring = NULL;
+    goto error;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    uring.cq_ring = uring.sq_ring;
+  } else {
+    uring.cq_ring =
+        mmap(NULL, uring.cq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_CQ_RING);
+    if (uring.cq_ring == MAP_FAILED) {
+      uring.cq_ring = NULL;
+      goto error;
+    }
+  }
+  uring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  uring.sqes = mmap(NULL, uring.sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQES);
+  if (uring.sqes == MAP_FAILED) {
+    uring.sqes = NULL;
+    goto error;
+  }
+
+  uint8_t *sq_ring = uring.sq_ring;
+  uint8_t *cq_ring = uring.cq_ring;
+  uring.sq_tail = (unsigned *)(sq_ring + params.sq_off.tail);
+  uring.sq_mask = (unsigned *)(sq_ring + params.sq_off.ring_mask);
+  uring.sq_array = (unsigned *)(sq_ring + params.sq_off.array);
+  uring.cq_head = (unsigned *)(cq_ring + params.cq_off.head);
+  uring.cq_tail = (unsigned *)(cq_ring + params.cq_off.tail);
+  uring.cq_mask = (unsigned *)(cq_ring + params.cq_off.ring_mask);
+  uring.cqes = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+  // The kernel pins the buffers once, instead of on every operation
+  const struct iovec buffers[URING_OPERATION_COUNT] = {
+      {uring_buffers.udp_in, sizeof(uring_buffers.udp_in)},
+      {uring_buffers.lns_in, sizeof(uring_buffers.lns_in)},
+      {uring_buffers.tx, sizeof(uring_buffers.tx)},
+  };
+  if (syscall(__NR_io_uring_register, uring.fd, IORING_REGISTER_BUFFERS,
+              buffers, URING_OPERATION_COUNT) == -1 ||
+      syscall(__NR_io_uring_register, uring.fd, IORING_REGISTER_FILES, files,
+              URING_FILE_COUNT) == -1) {
+    goto error;
+  }
+  return true;
+
+error:;
+  int error = errno;
+  uring_destroy();
+  errno = error;
+  return false;
+}
+
+/**
+ * \brief Queues an operation on a registered socket and a registered buffer,
+ * submitted by the next call to uring_submit().
+ *
+ * \param[in] operation Operation, also the index of its buffer.
+ * \param[in] opcode IORING_OP_READ_FIXED or IORING_OP_WRITE_FIXED.
+ * \param[in] file Registered socket.
+ * \param[in] address Start of the data in the buffer.
+ * \param[in] size Size of the data.
+ */
+static void uring_queue(uring_operation_t operation, uint8_t opcode,
+                        uring_file_t file, void *address, size_t size) {
+
+  unsigned tail = *uring.sq_tail;
+  unsigned index = tail & *uring.sq_mask;
+  struct io_uring_sqe *sqe = &uring.sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->flags = IOSQE_FIXED_FILE;
+  sqe->fd = file;
+  sqe->addr = (uint64_t)(uintptr_t)address;
+  sqe->len = (uint32_t)size;
+  sqe->buf_index = (uint16_t)operation;
+  sqe->user_data = operation;
+  uring.sq_array[index] = index;
+  __atomic_store_n(uring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  uring.queued++;
+  uring_in_flight[operation] = true;
+}
+
+/**
+ * \brief Queues a receive into the free space of a stream, unless one is in
+ * flight. The messages already read are discarded first.
+ *
+ * \param[in] operation URING_UDP_IN or URING_LNS_IN.
+ */
+static void uring_receive(uring_operation_t operation) {
+
+  struct uring_stream_t *stream = &uring_streams[operation];
+  if (uring_in_flight[operation]) {
+    return;
+  }
+  if (stream->start != 0) {
+    memmove(stream->buffer, stream->buffer + stream->start,
+            stream->end - stream->start);
+    stream->end -= stream->start;
+    stream->start = 0;
+  }
+  if (stream->end < stream->capacity) {
+    uring_queue(operation, IORING_OP_READ_FIXED,
+                operation == URING_UDP_IN ? URING_FILE_UDP : URING_FILE_LNS,
+                stream->buffer + stream->end, stream->capacity - stream->end);
+  }
+}
+
+/**
+ * \brief Queues a write of the messages not sent yet, unless one is in flight.
+ * The messages already sent are discarded first.
+ */
+static void uring_send(void) {
+
+  struct uring_output_t *output = &uring_output;
+  if (uring_in_flight[URING_TX]) {
+    return;
+  }
+  if (output->start != 0) {
+    memmove(uring_buffers.tx, uring_buffers.tx + output->start,
+            output->end - output->start);
+    output->end -= output->start;
+    output->start = 0;
+  }
+  if (output->end != 0) {
+    uring_queue(URING_TX, IORING_OP_WRITE_FIXED, URING_FILE_TX,
+                uring_buffers.tx, output->end);
+  }
+}
+
+/**
+ * \brief Reads the completed operations from the completion queue, without
+ * syscall.
+ */
+static void uring_reap(void) {
+
+  unsigned head = *uring.cq_head;
+  unsigned tail = __atomic_load_n(uring.cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    const struct io_uring_cqe *cqe = &uring.cqes[head & *uring.cq_mask];
+    uring_operation_t operation = (uring_operation_t)cqe->user_data;
+    uring_in_flight[operation] = false;
+
+    if (cqe->res < 0) {
+      uring_errors[operation] = -cqe->res;
+    } else if (cqe->res == 0) {
+      uring_errors[operation] = ECONNRESET; // bin/driver stopped
+    } else if (operation == URING_TX) {
+      // The rest of a short write is sent by the next submit
+      uring_output.start += (size_t)cqe->res;
+    } else {
+      uring_streams[operation].end += (size_t)cqe->res;
+    }
+    if (operation == URING_TX && uring_errors[URING_TX] != 0) {
+      // The message stream is broken, what remains of it is dropped
+      uring_output.start = uring_output.end;
+    }
+  }
+  __atomic_store_n(uring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Queues the receives and the write, then submits the queued
+ * operations, in a single syscall.
+ *
+ * \param[in] wait Whether to wait for an operation to complete.
+ * \return Whether the operations are submitted (errno is set otherwise).
+ */
+static bool uring_submit(bool wait) {
+
+  uring_receive(URING_UDP_IN);
+  uring_receive(URING_LNS_IN);
+  uring_send();
+
+  // The write completes at once, waiting for it too waits for a receive
+  unsigned completions = wait ? 1 + uring_in_flight[URING_TX] : 0;
+  int submitted =
+      (int)syscall(__NR_io_uring_enter, uring.fd, uring.queued, completions,
+                   wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  uring_syscalls++;
+  if (submitted == -1) {
+    return errno == EINTR;
+  }
+  uring.queued -= (unsigned)submitted;
+  return true;
+}
+
+/**
+ * \brief Returns the next message of a stream, which the caller marks read by
+ * moving the start of the stream.
+ *
+ * \param[in] operation URING_UDP_IN or URING_LNS_IN.
+ * \return The message, or NULL if no complete message was received.
+ */
+static const uint8_t *uring_stream_next(uring_operation_t operation) {
+
+  const struct uring_stream_t *stream = &uring_streams[operation];
+  if (stream->end - stream->start < stream->message_size) {
+    return NULL;
+  }
+  return stream->buffer + stream->start;
+}
+
+/**
+ * \brief Appends a message to the messages sent to bin/driver, after the
+ * messages not sent yet.
+ *
+ * \param[in] message Message.
+ * \return Whether the message is appended (errno is set otherwise, to the
+ * error of a previous write if it failed).
+ */
+static bool uring_output_append(const struct drv_api_message_t *message) {
+
+  struct uring_output_t *output = &uring_output;
+  uring_reap();
+  while (uring_errors[URING_TX] == 0 &&
+         output->end + sizeof(*message) > sizeof(uring_buffers.tx)) {
+    // Full: the messages sent are discarded once no write is in flight
+    if (!uring_submit(uring_in_flight[URING_TX])) {
+      return false;
+    }
+    uring_reap();
+  }
+  if (uring_errors[URING_TX] != 0) {
+    errno = uring_errors[URING_TX];
+    uring_errors[URING_TX] = 0;
+    return false;
+  }
+
+  // Copied, as the rest of a short write leaves the end unaligned
+  memcpy(uring_buffers.tx + output->end, message, sizeof(*message));
+  output->end += sizeof(*message);
+  return true;
+}
+
+static int32_t uring_open(void) {
+
+  int32_t fd = drv_open();
+  if (fd == DRV_ERROR) {
+    return DRV_ERROR;
+  }
+
+  int files[URING_FILE_COUNT] = {drv_api_socket(DRV_API_UDP_PORT),
+                                 drv_api_socket(DRV_API_LNS_PORT),
+                                 drv_api_socket(DRV_API_TX_PORT)};
+  if (files[URING_FILE_UDP] == -1 || files[URING_FILE_LNS] == -1 ||
+      files[URING_FILE_TX] == -1) {
+    goto error;
+  }
+  // io_uring fails at once on a non-blocking socket without data, instead of
+  // completing when data arrives
+  int flags = fcntl(files[URING_FILE_LNS], F_GETFL);
+  if (flags == -1 ||
+      fcntl(files[URING_FILE_LNS], F_SETFL, flags & ~O_NONBLOCK) == -1) {
+    goto error;
+  }
+  if (!uring_create(files)) {
+    goto error;
+  }
+
+  memset(&uring_buffers, 0, sizeof(uring_buffers));
+  uring_streams[URING_UDP_IN] = (struct uring_stream_t){
+      .buffer = uring_buffers.udp_in,
+      .capacity = sizeof(uring_buffers.udp_in),
+      .message_size = sizeof(struct drv_api_udp_message_t),
+  };
+  uring_streams[URING_LNS_IN] = (struct uring_stream_t){
+      .buffer = uring_buffers.lns_in,
+      .capacity = sizeof(uring_buffers.lns_in),
+      .message_size = sizeof(struct drv_api_message_t),
+  };
+  memset(&uring_output, 0, sizeof(uring_output));
+  memset(uring_in_flight, 0, sizeof(uring_in_flight));
+  memset(uring_errors, 0, sizeof(uring_errors));
+  uring_cycles = 0;
+  uring_syscalls = 0;
+  uring_start_cpu_time = driver_cpu_time();
+  uring_driver_fd = fd;
+  return fd;
+
+error:;
+  int error = errno;
+  drv_close(fd);
+  errno = error;
+  return DRV_ERROR;
+}
+
+static int32_t uring_read_udp_10ms(int32_t fd,
+                                   uint8_t frame[DRV_UDP_10MS_FRAME_SIZE]) {
+
+  if (fd != uring_driver_fd) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // The writes of the previous cycle are submitted along with the wait
+  bool submitted = false;
+  const uint8_t *message;
+  uring_reap();
+  while ((message = uring_stream_next(URING_UDP_IN)) == NULL) {
+    if (uring_errors[URING_UDP_IN] != 0) {
+      errno = uring_errors[URING_UDP_IN];
+      return DRV_ERROR;
+    }
+    if (!uring_submit(true)) {
+      return DRV_ERROR;
+    }
+    submitted = true;
+    uring_reap();
+  }
+  if (!submitted && uring.queued > 0 && !uring_submit(false)) {
+    return DRV_ERROR;
+  }
+
+  memcpy(frame, message + offsetof(struct drv_api_udp_message_t, frame),
+         DRV_UDP_10MS_FRAME_SIZE);
+  uring_streams[URING_UDP_IN].start += sizeof(struct drv_api_udp_message_t);
+  uring_cycles++;
+  return DRV_SUCCESS;
+}
+
+static int32_t uring_write_udp_20ms(int32_t fd,
+                                    uint8_t frame[DRV_UDP_20MS_FRAME_SIZE]) {
+
+  if (fd != uring_driver_fd) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  struct drv_api_message_t message;
+  memset(&message, 0, sizeof(message));
+  message.type = DRV_API_MESSAGE_UDP_20MS;
+  message.size = DRV_UDP_20MS_FRAME_SIZE;
+  memcpy(message.udp_frame, frame, DRV_UDP_20MS_FRAME_SIZE);
+  return uring_output_append(&message) ? DRV_SUCCESS : DRV_ERROR;
+}
+
+static int32_t uring_read_lns(int32_t fd, lns_frame_t frames[DRV_MAX_FRAMES],
+                              uint32_t *frame_count) {
+
+  if (fd != uring_driver_fd) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // Messages received since the last cycle, without syscall. The frames that
+  // don't fit are read by the next call.
+  *frame_count = 0;
+  uring_reap();
+  const uint8_t *next;
+  while ((next = uring_stream_next(URING_LNS_IN)) != NULL) {
+    struct drv_api_message_t message;
+    memcpy(&message, next, sizeof(message));
+    if (message.size > DRV_MAX_FRAMES) {
+      errno = EPROTO;
+      return DRV_ERROR;
+    }
+    if (*frame_count + message.size > DRV_MAX_FRAMES) {
+      break;
+    }
+    memcpy(&frames[*frame_count], message.lns_frames,
+           message.size * sizeof(lns_frame_t));
+    *frame_count += message.size;
+    uring_streams[URING_LNS_IN].start += sizeof(message);
+  }
+  if (*frame_count == 0 && uring_errors[URING_LNS_IN] != 0) {
+    errno = uring_errors[URING_LNS_IN];
+    return DRV_ERROR;
+  }
+  return DRV_SUCCESS;
+}
+
+static int32_t uring_write_lns(int32_t fd, lns_frame_t *frames,
+                               uint32_t frame_count) {
+
+  if (fd != uring_driver_fd || frame_count == 0 ||
+      frame_count > DRV_MAX_FRAMES) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  struct drv_api_message_t message;
+  memset(&message, 0, sizeof(message));
+  message.type = DRV_API_MESSAGE_LNS;
+  message.size = frame_count;
+  memcpy(message.lns_frames, frames, frame_count * sizeof(lns_frame_t));
+  return uring_output_append(&message) ? DRV_SUCCESS : DRV_ERROR;
+}
+
+static int32_t uring_close(int32_t fd) {
+
+  if (fd != uring_driver_fd) {
+    errno = EBADF;
+    return DRV_ERROR;
+  }
+
+  // Last writes of the application, the receives completing meanwhile
+  const struct uring_output_t *output = &uring_output;
+  uring_reap();
+  while (uring_errors[URING_TX] == 0 &&
+         (uring_in_flight[URING_TX] || output->start != output->end)) {
+    if (!uring_submit(true)) {
+      break;
+    }
+    uring_reap();
+  }
+
+  double cpu_time = driver_cpu_time() - uring_start_cpu_time;
+  if (fprintf(stderr,
+              "[INFO] io_uring driver served %" PRIu64
+              " cycles with %.2f syscalls/cycle and %.1f us of CPU/cycle\n",
+              uring_cycles,
+              uring_cycles != 0
+                  ? (double)uring_syscalls / (double)uring_cycles
+                  : 0.0,
+              uring_cycles != 0 ? cpu_time * 1e6 / (double)uring_cycles
+                                : 0.0) < 0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+
+  uring_destroy();
+  uring_driver_fd = DRV_ERROR;
+  return drv_close(fd);
+}
+
+const struct driver_t driver_uring = {
+    .name = "uring",
+    .open = uring_open,
+    .read_udp_10ms = uring_read_udp_10ms,
+    .write_udp_20ms = uring_write_udp_20ms,
+    .read_lns = uring_read_lns,
+    .write_lns = uring_write_lns,
+    .close = uring_close,
+    .channel_fd = NULL, // Waits on its ring
+    .read_udp_received = NULL,
+};
@@ -0,0 +1,61 @@
+/**
+ * \brief This file defines the messages exchanged between drv_api.a and
+ * bin/driver, and the lookup of the sockets of drv_api.a, for the backends that
+ * talk to bin/driver without going through drv_api.a.
+ *
+ * drv_api.a connects three TCP sockets to bin/driver: the UDP 10ms frames are
+ * received on the first one, the LNS frames on the second one, and the frames
+ * written by the application are sent on the third one.
+ */
+#ifndef DRV_API_WIRE_H
+#define DRV_API_WIRE_H
+
+#include <stdint.h>
+
+#include "lib/drv_api.h"
+
+#define DRV_API_UDP_PORT 9002
+#define DRV_API_LNS_PORT 9003
+#define DRV_API_TX_PORT 9004
+
+/**
+ * \brief Types of the messages sent to bin/driver.
+ */
+typedef enum drv_api_message_type_t {
+  DRV_API_MESSAGE_UDP_20MS = 0,
+  DRV_API_MESSAGE_LNS = 2
+} drv_api_message_type_t;
+
+/**
+ * \brief Message of bin/driver carrying a UDP 10ms frame.
+ */
+struct drv_api_udp_message_t {
+  uint32_t type;
+  uint32_t size;
+  uint8_t frame[DRV_UDP_10MS_FRAME_SIZE];
+};
+
+/**
+ * \brief Message carrying LNS frames, received from or sent to bin/driver, or
+ * a UDP 20ms frame sent to bin/driver. size is the number of LNS frames, or
+ * the size of the UDP frame.
+ */
+struct drv_api_message_t {
+  uint32_t type;
+  uint32_t size;
+  union {
+    lns_frame_t lns_frames[DRV_MAX_FRAMES];
+    uint8_t udp_frame[DRV_UDP_20MS_FRAME_SIZE];
+  };
+};
+
+/**
+ * \brief Finds the socket of drv_api.a connected to a port of bin/driver.
+ * drv_api.a keeps its sockets private, they are found by their peer address.
+ *
+ * \param[in] port Port of bin/driver.
+ * \return The socket, or -1 if it isn't found (errno is set).
+ */
+int drv_api_socket(uint16_t port);
+
+#endif // DRV_API_WIRE_H
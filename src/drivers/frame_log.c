@@ -0,0 +1,300 @@
+/**
+ * \brief This file implements the frame log (see frame_log.h).
+ */
+#define _GNU_SOURCE // mremap()
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frame_log.h"
+
+#define FRAME_LOG_INITIAL_SIZE (1 << 20)
+#define FRAME_LOG_ALIGNMENT 8
+
+#define FRAME_LOG_HEADER(log_p) ((struct frame_log_header_t *)(log_p)->map)
+#define FRAME_LOG_ENTRIES(log_p)                                               \
+  ((log_p)->map + sizeof(struct frame_log_header_t))
+
+/**
+ * \brief Returns the size of an entry with its payload, padding included.
+ *
+ * \param[in] payload_size_p Size of the payload.
+ * \return The size of the entry.
+ */
+static size_t frame_log_entry_size(size_t payload_size_p) {
+
+  size_t size = sizeof(struct frame_log_entry_t) + payload_size_p;
+  return (size + FRAME_LOG_ALIGNMENT - 1) & ~(size_t)(FRAME_LOG_ALIGNMENT - 1);
+}
+
+/**
+ * \brief Grows the file and the mapping of a frame log opened for recording,
+ * so that it can hold size bytes.
+ *
+ * \param[in,out] log_p Frame log.
+ * \param[in] size_p Size needed.
+ * \return true on success, false on failure (errno is set).
+ */
+static bool frame_log_reserve(struct frame_log_t *log_p, size_t size_p) {
+
+  if (size_p <= log_p->map_size) {
+    return true;
+  }
+  size_t map_size = log_p->map_size;
+  while (map_size < size_p) {
+    map_size *= 2;
+  }
+  if (ftruncate(log_p->fd, (off_t)map_size) == -1) {
+    return false;
+  }
+  uint8_t *map = mremap(log_p->map, log_p->map_size, map_size, MREMAP_MAYMOVE);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  log_p->map = map;
+  log_p->map_size = map_size;
+  return true;
+}
+
+/**
+ * \brief Checks whether an entry of a frame log, header and payload, lies
+ * within its entries.
+ *
+ * \param[in] log_p Frame log.
+ * \param[in] offset_p Offset of the entry.
+ * \return Whether the entry is complete.
+ */
+static bool frame_log_entry_fits(const struct frame_log_t *log_p,
+                                 uint64_t offset_p) {
+
+  uint64_t entries_size = FRAME_LOG_HEADER(log_p)->entries_size;
+  if (offset_p % FRAME_LOG_ALIGNMENT != 0 ||
+      offset_p + sizeof(struct frame_log_entry_t) > entries_size) {
+    return false;
+  }
+  const struct frame_log_entry_t *entry =
+      (const struct frame_log_entry_t *)&FRAME_LOG_ENTRIES(log_p)[offset_p];
+  return offset_p + frame_log_entry_size(entry->size) <= entries_size;
+}
+
+/**
+ * \brief Builds the index of a frame log from its entries: the offset of each
+ * UDP 10ms frame entry.
+ *
+ * \param[in,out] log_p Frame log.
+ * \return true on success, false on failure (errno is set, EINVAL if an entry
+ * overruns the entries).
+ */
+static bool frame_log_build_index(struct frame_log_t *log_p) {
+
+  const struct frame_log_header_t *header = FRAME_LOG_HEADER(log_p);
+  const uint8_t *entries = FRAME_LOG_ENTRIES(log_p);
+  uint64_t capacity = 1024;
+  log_p->cycle_count = 0;
+  log_p->index = malloc(capacity * sizeof(uint64_t));
+  if (log_p->index == NULL) {
+    return false;
+  }
+
+  uint64_t offset = 0;
+  while (offset < header->entries_size) {
+    if (!frame_log_entry_fits(log_p, offset)) {
+      errno = EINVAL;
+      return false;
+    }
+    const struct frame_log_entry_t *entry =
+        (const struct frame_log_entry_t *)&entries[offset];
+    if (entry->type == FRAME_LOG_UDP_IN) {
+      if (log_p->cycle_count == capacity) {
+        capacity *= 2;
+        uint64_t *index = realloc(log_p->index, capacity * sizeof(uint64_t));
+        if (index == NULL) {
+          return false;
+        }
+        log_p->index = index;
+      }
+      log_p->index[log_p->cycle_count++] = offset;
+    }
+    offset += frame_log_entry_size(entry->size);
+  }
+  return true;
+}
+
+bool frame_log_create(struct frame_log_t *log, const char *path) {
+
+  *log = (struct frame_log_t){.fd = -1, .writable = true};
+  log->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (log->fd == -1) {
+    return false;
+  }
+  if (ftruncate(log->fd, FRAME_LOG_INITIAL_SIZE) == -1) {
+    close(log->fd);
+    return false;
+  }
+  log->map = mmap(NULL, FRAME_LOG_INITIAL_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_SHARED, log->fd, 0);
+  if (log->map == MAP_FAILED) {
+    close(log->fd);
+    return false;
+  }
+  log->map_size = FRAME_LOG_INITIAL_SIZE;
+
+  *FRAME_LOG_HEADER(log) = (struct frame_log_header_t){
+      .magic = FRAME_LOG_MAGIC, .version = FRAME_LOG_VERSION};
+  return true;
+}
+
+bool frame_log_append(struct frame_log_t *log, frame_log_entry_type_t type,
+                      const uint8_t *udp_frame, size_t udp_frame_size,
+                      const lns_frame_t *lns_frames, uint32_t lns_frame_count) {
+
+  bool is_lns = type == FRAME_LOG_LNS_IN || type == FRAME_LOG_LNS_OUT;
+  size_t payload_size = is_lns ? lns_frame_count *
+                                     sizeof(struct frame_log_lns_frame_t)
+                               : udp_frame_size;
+  size_t entry_size = frame_log_entry_size(payload_size);
+  uint64_t offset = FRAME_LOG_HEADER(log)->entries_size;
+  if (!frame_log_reserve(log, sizeof(struct frame_log_header_t) + offset +
+                                  entry_size)) {
+    return false;
+  }
+
+  struct frame_log_entry_t *entry =
+      (struct frame_log_entry_t *)&FRAME_LOG_ENTRIES(log)[offset];
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  *entry = (struct frame_log_entry_t){
+      .timestamp = (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec,
+      .type = (uint8_t)type,
+      .count = (uint8_t)lns_frame_count,
+      .size = (uint16_t)payload_size};
+  if (is_lns) {
+    struct frame_log_lns_frame_t *frames =
+        (struct frame_log_lns_frame_t *)entry->payload;
+    for (uint32_t i = 0; i < lns_frame_count; i++) {
+      frames[i] = (struct frame_log_lns_frame_t){
+          .serial_number = lns_frames[i].serNum,
+          .size = (uint8_t)lns_frames[i].frameSize};
+      memcpy(frames[i].frame, lns_frames[i].frame, LNS_MAX_FRAME_SIZE);
+    }
+  } else {
+    memcpy(entry->payload, udp_frame, udp_frame_size);
+  }
+
+  // The entry is counted once written, so that an interrupted recording
+  // leaves a log of complete entries
+  FRAME_LOG_HEADER(log)->entries_size = offset + entry_size;
+  return true;
+}
+
+bool frame_log_open(struct frame_log_t *log, const char *path) {
+
+  *log = (struct frame_log_t){.fd = -1, .writable = false};
+  log->fd = open(path, O_RDONLY);
+  if (log->fd == -1) {
+    return false;
+  }
+  struct stat status;
+  if (fstat(log->fd, &status) == -1) {
+    close(log->fd);
+    return false;
+  }
+  if ((size_t)status.st_size < sizeof(struct frame_log_header_t)) {
+    close(log->fd);
+    errno = EINVAL;
+    return false;
+  }
+  log->map_size = (size_t)status.st_size;
+  log->map = mmap(NULL, log->map_size, PROT_READ, MAP_PRIVATE, log->fd, 0);
+  if (log->map == MAP_FAILED) {
+    close(log->fd);
+    return false;
+  }
+
+  const struct frame_log_header_t *header = FRAME_LOG_HEADER(log);
+  if (header->magic != FRAME_LOG_MAGIC ||
+      header->version != FRAME_LOG_VERSION ||
+      header->entries_size >
+          log->map_size - sizeof(struct frame_log_header_t)) {
+    frame_log_close(log);
+    errno = EINVAL;
+    return false;
+  }
+
+  if (header->index_offset != 0 &&
+      header->index_offset + header->cycle_count * sizeof(uint64_t) <=
+          log->map_size) {
+    log->cycle_count = header->cycle_count;
+    log->index = malloc(log->cycle_count * sizeof(uint64_t));
+    if (log->index == NULL && log->cycle_count != 0) {
+      frame_log_close(log);
+      return false;
+    }
+    memcpy(log->index, &log->map[header->index_offset],
+           log->cycle_count * sizeof(uint64_t));
+  } else if (!frame_log_build_index(log)) { // Interrupted recording
+    frame_log_close(log);
+    return false;
+  }
+  return true;
+}
+
+bool frame_log_seek(struct frame_log_t *log, uint64_t cycle) {
+
+  if (cycle >= log->cycle_count) {
+    return false;
+  }
+  log->cursor = log->index[cycle];
+  return true;
+}
+
+const struct frame_log_entry_t *frame_log_peek(const struct frame_log_t *log) {
+
+  if (!frame_log_entry_fits(log, log->cursor)) {
+    return NULL;
+  }
+  return (const struct frame_log_entry_t *)&FRAME_LOG_ENTRIES(log)[log->cursor];
+}
+
+const struct frame_log_entry_t *frame_log_next(struct frame_log_t *log) {
+
+  const struct frame_log_entry_t *entry = frame_log_peek(log);
+  if (entry != NULL) {
+    log->cursor += frame_log_entry_size(entry->size);
+  }
+  return entry;
+}
+
+bool frame_log_close(struct frame_log_t *log) {
+
+  bool success = true;
+  if (log->writable) {
+    // Append the index after the entries
+    struct frame_log_header_t *header = FRAME_LOG_HEADER(log);
+    uint64_t index_offset =
+        sizeof(struct frame_log_header_t) + header->entries_size;
+    success = frame_log_build_index(log);
+    if (success) {
+      size_t index_size = log->cycle_count * sizeof(uint64_t);
+      success = frame_log_reserve(log, index_offset + index_size);
+      if (success) {
+        header = FRAME_LOG_HEADER(log); // The mapping may have moved
+        memcpy(&log->map[index_offset], log->index, index_size);
+        header->cycle_count = log->cycle_count;
+        header->index_offset = index_offset;
+        success = msync(log->map, log->map_size, MS_SYNC) == 0 &&
+                  ftruncate(log->fd, (off_t)(index_offset + index_size)) == 0;
+      }
+    }
+  }
+  munmap(log->map, log->map_size);
+  close(log->fd);
+  free(log->index);
+  *log = (struct frame_log_t){.fd = -1};
+  return success;
+}
@@ -0,0 +1,157 @@
+/**
+ * \brief This file defines the frame log: an append-only binary log of the
+ * frames exchanged with the driver, memory-mapped both when recording and when
+ * replaying, with an index of the cycles.
+ *
+ * The log starts with a header, followed by the entries, each one a frame or a
+ * batch of LNS frames with its monotonic timestamp. A cycle starts with the
+ * entry of its UDP 10ms frame. When the log is closed, the offsets of the
+ * cycles are appended after the entries; a log whose recording was interrupted
+ * has no index, which is then rebuilt from the entries when it is opened.
+ */
+#ifndef FRAME_LOG_H
+#define FRAME_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib/drv_api.h"
+
+#define FRAME_LOG_MAGIC 0x474f4c56u // "VLOG" in little endian
+#define FRAME_LOG_VERSION 1
+
+/**
+ * \brief Types of the entries of a frame log.
+ */
+typedef enum frame_log_entry_type_t {
+  FRAME_LOG_UDP_IN = 0,  // Frame read by read_udp_10ms()
+  FRAME_LOG_LNS_IN = 1,  // Frames read by read_lns()
+  FRAME_LOG_UDP_OUT = 2, // Frame written by write_udp_20ms()
+  FRAME_LOG_LNS_OUT = 3  // Frames written by write_lns()
+} frame_log_entry_type_t;
+
+/**
+ * \brief Header of a frame log file.
+ */
+struct frame_log_header_t {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t entries_size; // Bytes of entries following the header
+  uint64_t index_offset; // Offset of the index in the file, 0 if none
+  uint64_t cycle_count;  // Number of offsets in the index
+};
+
+/**
+ * \brief LNS frame, as stored in a frame log.
+ */
+struct frame_log_lns_frame_t {
+  uint32_t serial_number;
+  uint8_t size;
+  uint8_t frame[LNS_MAX_FRAME_SIZE];
+  uint8_t reserved;
+};
+
+/**
+ * \brief Entry of a frame log, followed by its payload: the UDP frame, or
+ * count LNS frames stored as frame_log_lns_frame_t. Entries are aligned on 8
+ * bytes.
+ */
+struct frame_log_entry_t {
+  uint64_t timestamp; // CLOCK_MONOTONIC, in nanoseconds
+  uint8_t type;       // frame_log_entry_type_t
+  uint8_t count;      // Number of LNS frames
+  uint16_t size;      // Size of the payload, in bytes
+  uint32_t reserved;
+  uint8_t payload[];
+};
+
+/**
+ * \brief Frame log opened for recording or replaying.
+ */
+struct frame_log_t {
+  int fd;
+  bool writable;
+  // Mapping of the file (header, then entries), grown when recording
+  uint8_t *map;
+  size_t map_size;
+  // Offsets of the cycles, relative to the first entry
+  uint64_t *index;
+  uint64_t cycle_count;
+  // Offset of the next entry to read, when replaying
+  uint64_t cursor;
+};
+
+/**
+ * \brief Creates a frame log for recording, truncating the file if it exists.
+ *
+ * \param[out] log Frame log to create.
+ * \param[in] path Path of the log file.
+ * \return true on success, false on failure (errno is set).
+ */
+bool frame_log_create(struct frame_log_t *log, const char *path);
+
+/**
+ * \brief Appends an entry to a frame log opened for recording. Only memory is
+ * written, unless the mapping of the log has to grow.
+ *
+ * \param[in,out] log Frame log.
+ * \param[in] type Type of the entry (frame_log_entry_type_t).
+ * \param[in] udp_frame UDP frame, for the UDP entries.
+ * \param[in] udp_frame_size Size of the UDP frame.
+ * \param[in] lns_frames LNS frames, for the LNS entries.
+ * \param[in] lns_frame_count Number of LNS frames.
+ * \return true on success, false on failure (errno is set).
+ */
+bool frame_log_append(struct frame_log_t *log, frame_log_entry_type_t type,
+                      const uint8_t *udp_frame, size_t udp_frame_size,
+                      const lns_frame_t *lns_frames, uint32_t lns_frame_count);
+
+/**
+ * \brief Opens a frame log for replaying, rebuilding its index if needed.
+ *
+ * \param[out] log Frame log to open.
+ * \param[in] path Path of the log file.
+ * \return true on success, false on failure (errno is set).
+ */
+bool frame_log_open(struct frame_log_t *log, const char *path);
+
+/**
+ * \brief Moves the replay cursor of a frame log to the start of a cycle.
+ *
+ * \param[in,out] log Frame log opened for replaying.
+ * \param[in] cycle Index of the cycle.
+ * \return true on success, false if the log has no such cycle.
+ */
+bool frame_log_seek(struct frame_log_t *log, uint64_t cycle);
+
+/**
+ * \brief Reads the entry under the replay cursor of a frame log and moves the
+ * cursor to the next entry.
+ *
+ * \param[in,out] log Frame log opened for replaying.
+ * \return The entry, or NULL at the end of the log or if the entry overruns
+ * the entries of the log.
+ */
+const struct frame_log_entry_t *frame_log_next(struct frame_log_t *log);
+
+/**
+ * \brief Reads the entry under the replay cursor of a frame log, without
+ * moving the cursor.
+ *
+ * \param[in] log Frame log opened for replaying.
+ * \return The entry, or NULL at the end of the log or if the entry overruns
+ * the entries of the log.
+ */
+const struct frame_log_entry_t *frame_log_peek(const struct frame_log_t *log);
+
+/**
+ * \brief Closes a frame log. When recording, writes the index of the cycles
+ * and writes the log back to its file.
+ *
+ * \param[in,out] log Frame log.
+ * \return true on success, false on failure (errno is set).
+ */
+bool frame_log_close(struct frame_log_t *log);
+
+#endif // FRAME_LOG_H
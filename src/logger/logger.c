@@ -0,0 +1,183 @@
+/**
+ * \brief This file implements the asynchronous logger.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "logger.h"
+
+#define LOGGER_MASK (LOGGER_CAPACITY - 1)
+#define LOGGER_NS_PER_S 1000000000u
+#define LOGGER_NS_PER_MS 1000000u
+
+/**
+ * \brief Description of a message.
+ */
+struct logger_format_t {
+  const char *name;
+  const char *format; // Takes the LOGGER_ARGUMENT_COUNT arguments, written
+                      // after the "[WARN] [timestamp] " prefix
+};
+
+static const struct logger_format_t logger_formats[LOGGER_MESSAGE_COUNT] = {
+    [LOGGER_MUX_ID_MISMATCH] = {"mux_id_mismatch",
+                                "Received MUX frame ID (%" PRIu32 ")"
+                                " but expected (%" PRIu32 ")\n"},
+    [LOGGER_COMMODOS_CRC_MISMATCH] = {"commodos_crc_mismatch",
+                                      "Checksum verification failed"
+                                      " (expected %" PRIX32
+                                      ", found %" PRIX32 ")\n"},
+};
+
+// Ring buffer: head is written by the producer, tail by the drain thread
+static struct logger_record_t logger_records[LOGGER_CAPACITY];
+static uint64_t logger_head __attribute__((aligned(64)));
+static uint64_t logger_tail __attribute__((aligned(64)));
+
+// Rate limiting, written by the producer only
+static uint64_t logger_window_start[LOGGER_MESSAGE_COUNT];
+static uint32_t logger_window_count[LOGGER_MESSAGE_COUNT];
+
+// Counters read by the drain thread
+static uint64_t logger_suppressed[LOGGER_MESSAGE_COUNT];
+static uint64_t logger_dropped;
+static uint64_t logger_reported[LOGGER_MESSAGE_COUNT]; // Drain thread only
+
+static pthread_t logger_thread;
+static bool logger_started = false;
+static bool logger_stopping = false;
+
+/**
+ * \brief Reads the clock of the records.
+ *
+ * \return CLOCK_MONOTONIC_COARSE, in nanoseconds.
+ */
+static uint64_t logger_now(void) {
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  return (uint64_t)now.tv_sec * LOGGER_NS_PER_S + (uint64_t)now.tv_nsec;
+}
+
+void logger_log(logger_message_t message, uint32_t argument_0,
+                uint32_t argument_1) {
+
+  uint64_t now = logger_now();
+  if (now - logger_window_start[message] >= LOGGER_NS_PER_S) {
+    logger_window_start[message] = now;
+    logger_window_count[message] = 0;
+  }
+  if (logger_window_count[message] == LOGGER_RATE_LIMIT) {
+    __atomic_store_n(
+        &logger_suppressed[message],
+        __atomic_load_n(&logger_suppressed[message], __ATOMIC_RELAXED) + 1,
+        __ATOMIC_RELAXED);
+    return;
+  }
+  logger_window_count[message]++;
+
+  uint64_t head = logger_head;
+  if (head - __atomic_load_n(&logger_tail, __ATOMIC_ACQUIRE) ==
+      LOGGER_CAPACITY) {
+    __atomic_store_n(&logger_dropped,
+                     __atomic_load_n(&logger_dropped, __ATOMIC_RELAXED) + 1,
+                     __ATOMIC_RELAXED);
+    return;
+  }
+  struct logger_record_t *record = &logger_records[head & LOGGER_MASK];
+  record->timestamp = now;
+  record->message = message;
+  record->arguments[0] = argument_0;
+  record->arguments[1] = argument_1;
+  __atomic_store_n(&logger_head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Writes the records of the ring buffer, then the records suppressed
+ * since the last drain.
+ *
+ * \param[in,out] reported Suppressed records already reported, per message.
+ */
+static void logger_drain(uint64_t reported[LOGGER_MESSAGE_COUNT]) {
+
+  uint64_t tail = logger_tail;
+  uint64_t head = __atomic_load_n(&logger_head, __ATOMIC_ACQUIRE);
+  for (; tail != head; tail++) {
+    const struct logger_record_t *record = &logger_records[tail & LOGGER_MASK];
+    if (record->message < LOGGER_MESSAGE_COUNT) {
+      // The timestamp is when the warning was raised, up to
+      // LOGGER_DRAIN_PERIOD_MS before it is written
+      flockfile(stderr);
+      if (fprintf(stderr, "[WARN] [%" PRIu64 ".%03" PRIu64 "] ",
+                  record->timestamp / LOGGER_NS_PER_S,
+                  record->timestamp % LOGGER_NS_PER_S / LOGGER_NS_PER_MS) < 0 ||
+          fprintf(stderr, logger_formats[record->message].format,
+                  record->arguments[0], record->arguments[1]) < 0) {
+        perror("[WARN] Failed to write to stderr");
+      }
+      funlockfile(stderr);
+    }
+    __atomic_store_n(&logger_tail, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  for (uint32_t i = 0; i < LOGGER_MESSAGE_COUNT; i++) {
+    uint64_t suppressed =
+        __atomic_load_n(&logger_suppressed[i], __ATOMIC_RELAXED);
+    if (suppressed != reported[i] &&
+        fprintf(stderr, "[WARN] %" PRIu64 " %s messages suppressed\n",
+                suppressed - reported[i], logger_formats[i].name) < 0) {
+      perror("[WARN] Failed to write to stderr");
+    }
+    reported[i] = suppressed;
+  }
+}
+
+/**
+ * \brief Drains the ring buffer every LOGGER_DRAIN_PERIOD_MS until stopped.
+ *
+ * \param[in] argument Suppressed records already reported, per message.
+ * \return NULL.
+ */
+static void *logger_run(void *argument) {
+
+  uint64_t *reported = argument;
+  const struct timespec period = {
+      .tv_sec = 0, .tv_nsec = LOGGER_DRAIN_PERIOD_MS * 1000000};
+  while (!__atomic_load_n(&logger_stopping, __ATOMIC_ACQUIRE)) {
+    logger_drain(reported);
+    nanosleep(&period, NULL);
+  }
+  return NULL;
+}
+
+bool logger_start(void) {
+
+  logger_stopping = false;
+  int error = pthread_create(&logger_thread, NULL, logger_run, logger_reported);
+  if (error != 0) {
+    errno = error;
+    return false;
+  }
+  logger_started = true;
+  return true;
+}
+
+void logger_stop(void) {
+
+  if (logger_started) {
+    __atomic_store_n(&logger_stopping, true, __ATOMIC_RELEASE);
+    pthread_join(logger_thread, NULL);
+    logger_started = false;
+  }
+  logger_drain(logger_reported);
+
+  uint64_t dropped = __atomic_load_n(&logger_dropped, __ATOMIC_RELAXED);
+  if (dropped != 0 &&
+      fprintf(stderr, "[WARN] %" PRIu64 " log records dropped, ring full\n",
+              dropped) < 0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+}
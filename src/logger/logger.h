@@ -0,0 +1,67 @@
+/**
+ * \brief This file defines the asynchronous logger of the warnings raised in
+ * the 10ms loop.
+ *
+ * A warning is a binary record, a message ID and its arguments, pushed into a
+ * lock-free ring buffer: the loop pays for a few stores instead of a blocking
+ * write to stderr. A background thread formats and writes the records. Each
+ * message is rate limited to LOGGER_RATE_LIMIT records per second; the
+ * records beyond the limit or that don't fit in the ring buffer are counted
+ * and reported instead of being written.
+ *
+ * The ring buffer has a single producer: the warnings are logged by the thread
+ * running the cycle.
+ */
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LOGGER_CAPACITY 1024 // Records, a power of two
+#define LOGGER_RATE_LIMIT 10 // Records per message and per second
+#define LOGGER_DRAIN_PERIOD_MS 50
+#define LOGGER_ARGUMENT_COUNT 2
+
+/**
+ * \brief Messages of the logger, with their format in logger.c.
+ */
+typedef enum logger_message_t {
+  LOGGER_MUX_ID_MISMATCH = 0,       // Received ID, expected ID
+  LOGGER_COMMODOS_CRC_MISMATCH = 1, // Expected CRC, computed CRC
+  LOGGER_MESSAGE_COUNT = 2
+} logger_message_t;
+
+/**
+ * \brief Record of the ring buffer.
+ */
+struct logger_record_t {
+  uint64_t timestamp; // CLOCK_MONOTONIC_COARSE when logged, in nanoseconds
+  uint32_t message;
+  uint32_t arguments[LOGGER_ARGUMENT_COUNT];
+};
+
+/**
+ * \brief Starts the drain thread.
+ *
+ * \return Whether the thread is started (errno is set otherwise).
+ */
+bool logger_start(void);
+
+/**
+ * \brief Logs a message, unless it is rate limited or the ring buffer is full.
+ *
+ * \param[in] message Message.
+ * \param[in] argument_0 First argument of the format.
+ * \param[in] argument_1 Second argument of the format.
+ */
+void logger_log(logger_message_t message, uint32_t argument_0,
+                uint32_t argument_1);
+
+/**
+ * \brief Stops the drain thread, writes the remaining records and the counts
+ * of suppressed and dropped records.
+ */
+void logger_stop(void);
+
+#endif // LOGGER_H
@@ -0,0 +1,187 @@
+/**
+ * \brief This file implements the shared memory, the calibration and the dump
+ * of the stage probes.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "probes.h"
+
+#define PROBES_CALIBRATION_NS 10000000 // 10ms
+
+struct probes_t *probes = NULL;
+
+static volatile sig_atomic_t probes_dump_requested = 0;
+
+static const char *const probes_stage_names[PROBE_STAGE_COUNT] = {
+    [PROBE_STAGE_DECODE_MUX] = "decode_mux",
+    [PROBE_STAGE_DECODE_LNS] = "decode_lns",
+    [PROBE_STAGE_FSM_SIDELIGHTS] = "fsm_sidelights",
+    [PROBE_STAGE_FSM_HEADLIGHTS] = "fsm_headlights",
+    [PROBE_STAGE_FSM_REDLIGHTS] = "fsm_redlights",
+    [PROBE_STAGE_FSM_LEFT_BLINKER] = "fsm_left_blinker",
+    [PROBE_STAGE_FSM_RIGHT_BLINKER] = "fsm_right_blinker",
+    [PROBE_STAGE_FSM_WIPERS] = "fsm_wipers",
+    [PROBE_STAGE_INDICATORS] = "indicators",
+    [PROBE_STAGE_ENCODE_MUX] = "encode_mux",
+    [PROBE_STAGE_WRITE_UDP] = "write_udp",
+    [PROBE_STAGE_ENCODE_BGF] = "encode_bgf",
+    [PROBE_STAGE_WRITE_LNS] = "write_lns",
+    [PROBE_STAGE_CYCLE] = "cycle",
+};
+
+/**
+ * \brief Requests a dump, which is done outside of the signal handler.
+ *
+ * \param[in] signal_number Unused.
+ */
+static void probes_on_signal(int signal_number) {
+
+  (void)signal_number;
+  probes_dump_requested = 1;
+}
+
+/**
+ * \brief Returns CLOCK_MONOTONIC.
+ *
+ * \return CLOCK_MONOTONIC, in nanoseconds.
+ */
+static uint64_t probes_monotonic_now(void) {
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+bool probes_init(void) {
+
+  // Shared memory if possible, so that the histograms can be read by other
+  // processes, private memory otherwise
+  int fd = shm_open(PROBES_SHM_NAME, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1) {
+    if (ftruncate(fd, sizeof(struct probes_t)) == 0) {
+      probes = mmap(NULL, sizeof(struct probes_t), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    }
+    close(fd);
+  }
+  if (fd == -1 || probes == MAP_FAILED || probes == NULL) {
+    perror("[WARN] Failed to share stage probes");
+    probes = mmap(NULL, sizeof(struct probes_t), PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (probes == MAP_FAILED) {
+      probes = NULL;
+      return false;
+    }
+  }
+  memset(probes, 0, sizeof(*probes));
+  probes->magic = PROBES_MAGIC;
+  probes->version = PROBES_VERSION;
+  probes->stage_count = PROBE_STAGE_COUNT;
+  probes->bucket_count = PROBES_BUCKET_COUNT;
+
+  // Rate of the time stamp counter
+  uint64_t start_ns = probes_monotonic_now();
+  uint64_t start_ticks = probes_now();
+  struct timespec calibration = {0, PROBES_CALIBRATION_NS};
+  while (nanosleep(&calibration, &calibration) == -1 && errno == EINTR) {
+  }
+  probes->ticks_per_ns = (double)(probes_now() - start_ticks) /
+                         (double)(probes_monotonic_now() - start_ns);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = probes_on_signal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  return sigaction(SIGUSR1, &action, NULL) == 0;
+}
+
+void probes_poll(void) {
+
+  if (probes_dump_requested) {
+    probes_dump_requested = 0;
+    probes_dump();
+  }
+}
+
+/**
+ * \brief Returns the upper bound of a bucket.
+ *
+ * \param[in] index Index of the bucket.
+ * \return The highest value of the bucket, in ticks.
+ */
+static uint64_t probes_bucket_value(uint32_t index) {
+
+  uint32_t bucket = index >> PROBES_SUB_BUCKET_BITS;
+  uint64_t sub_bucket = index & (PROBES_SUB_BUCKET_COUNT - 1);
+  if (bucket == 0) {
+    return sub_bucket;
+  }
+  return ((PROBES_SUB_BUCKET_COUNT + sub_bucket + 1) << (bucket - 1)) - 1;
+}
+
+/**
+ * \brief Returns a percentile of a histogram.
+ *
+ * \param[in] counts Histogram.
+ * \param[in] total Number of values of the histogram.
+ * \param[in] quantile Quantile, between 0 and 1.
+ * \return Upper bound of the bucket of the percentile, in ticks.
+ */
+static uint64_t probes_percentile(const uint64_t *counts, uint64_t total,
+                                  double quantile) {
+
+  uint64_t rank = (uint64_t)(quantile * (double)total);
+  uint64_t cumulated = 0;
+  for (uint32_t i = 0; i < PROBES_BUCKET_COUNT; i++) {
+    cumulated += counts[i];
+    if (cumulated > rank) {
+      return probes_bucket_value(i);
+    }
+  }
+  return probes_bucket_value(PROBES_BUCKET_COUNT - 1);
+}
+
+void probes_dump(void) {
+
+  if (probes == NULL) {
+    return;
+  }
+  if (fprintf(stderr, "[INFO] %-18s %10s %10s %10s %10s %10s\n", "Stage (ns)",
+              "count", "p50", "p99", "p99.9", "max") < 0) {
+    perror("[WARN] Failed to write to stderr");
+    return;
+  }
+  for (uint32_t stage = 0; stage < PROBE_STAGE_COUNT; stage++) {
+    // Copy of the histogram, which the recording thread may be updating
+    uint64_t counts[PROBES_BUCKET_COUNT];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < PROBES_BUCKET_COUNT; i++) {
+      counts[i] = __atomic_load_n(&probes->counts[stage][i], __ATOMIC_RELAXED);
+      total += counts[i];
+    }
+    if (total == 0) {
+      continue;
+    }
+    double ns_per_tick = 1.0 / probes->ticks_per_ns;
+    if (fprintf(
+            stderr, "[INFO] %-18s %10" PRIu64 " %10.0f %10.0f %10.0f %10.0f\n",
+            probes_stage_names[stage], total,
+            (double)probes_percentile(counts, total, 0.5) * ns_per_tick,
+            (double)probes_percentile(counts, total, 0.99) * ns_per_tick,
+            (double)probes_percentile(counts, total, 0.999) * ns_per_tick,
+            (double)__atomic_load_n(&probes->max[stage], __ATOMIC_RELAXED) *
+                ns_per_tick) < 0) {
+      perror("[WARN] Failed to write to stderr");
+      return;
+    }
+  }
+}
@@ -0,0 +1,162 @@
+/**
+ * \brief This file defines the stage probes: the latency of each stage of a
+ * cycle, recorded into a log-linear histogram per stage.
+ *
+ * The probes are compiled out unless STAGE_PROBES is defined (make
+ * STAGE_PROBES=on). A probe reads the time stamp counter, so that a stage
+ * costs a few nanoseconds to record, and each stage is recorded by a single
+ * thread, without atomic read-modify-write. The histograms are kept in the
+ * shared memory object PROBES_SHM_NAME, where other processes can read them,
+ * and dumped to stderr on SIGUSR1 and when the application stops.
+ *
+ * A histogram bucket covers 1/PROBES_SUB_BUCKET_COUNT of a power of two, so
+ * that the percentiles are given within about 6%.
+ */
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROBES_SHM_NAME "/bcgv_stage_probes"
+#define PROBES_MAGIC 0x424f5250u // "PROB" in little endian
+#define PROBES_VERSION 1
+
+#define PROBES_SUB_BUCKET_BITS 4
+#define PROBES_SUB_BUCKET_COUNT (1 << PROBES_SUB_BUCKET_BITS)
+#define PROBES_MAX_BITS 40 // About 18 minutes at 1 GHz
+#define PROBES_BUCKET_COUNT                                                    \
+  ((PROBES_MAX_BITS - PROBES_SUB_BUCKET_BITS + 1) * PROBES_SUB_BUCKET_COUNT)
+
+/**
+ * \brief Stages of a cycle.
+ */
+typedef enum probe_stage_t {
+  PROBE_STAGE_DECODE_MUX = 0,
+  PROBE_STAGE_DECODE_LNS = 1,
+  PROBE_STAGE_FSM_SIDELIGHTS = 2,
+  PROBE_STAGE_FSM_HEADLIGHTS = 3,
+  PROBE_STAGE_FSM_REDLIGHTS = 4,
+  PROBE_STAGE_FSM_LEFT_BLINKER = 5,
+  PROBE_STAGE_FSM_RIGHT_BLINKER = 6,
+  PROBE_STAGE_FSM_WIPERS = 7,
+  PROBE_STAGE_INDICATORS = 8,
+  PROBE_STAGE_ENCODE_MUX = 9,
+  PROBE_STAGE_WRITE_UDP = 10,
+  PROBE_STAGE_ENCODE_BGF = 11,
+  PROBE_STAGE_WRITE_LNS = 12,
+  PROBE_STAGE_CYCLE = 13, // From the UDP 10ms frame read to the end of cycle
+  PROBE_STAGE_COUNT = 14
+} probe_stage_t;
+
+/**
+ * \brief Histograms of the shared memory object, in time stamp counter ticks.
+ */
+struct probes_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t stage_count;
+  uint32_t bucket_count;
+  double ticks_per_ns;
+  uint64_t counts[PROBE_STAGE_COUNT][PROBES_BUCKET_COUNT];
+  uint64_t max[PROBE_STAGE_COUNT];
+};
+
+#ifdef STAGE_PROBES
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * \brief Histograms being recorded, NULL before probes_init().
+ */
+extern struct probes_t *probes;
+
+/**
+ * \brief Reads the clock of the probes.
+ *
+ * \return Time stamp counter, or CLOCK_MONOTONIC in nanoseconds where there is
+ * none.
+ */
+static inline uint64_t probes_now(void) {
+
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Records a stage which started at a time, and starts the next stage.
+ *
+ * \param[in] stage Stage.
+ * \param[in,out] clock Start of the stage, set to its end.
+ */
+static inline void probes_record(probe_stage_t stage, uint64_t *clock) {
+
+  uint64_t now = probes_now();
+  uint64_t ticks = now - *clock;
+  *clock = now;
+
+  uint32_t index = (uint32_t)ticks;
+  if (ticks >= PROBES_SUB_BUCKET_COUNT) {
+    uint32_t bits = 63 - (uint32_t)__builtin_clzll(ticks);
+    uint32_t shift = bits - PROBES_SUB_BUCKET_BITS;
+    index = ((shift + 1) << PROBES_SUB_BUCKET_BITS) +
+            (uint32_t)((ticks >> shift) & (PROBES_SUB_BUCKET_COUNT - 1));
+    if (index >= PROBES_BUCKET_COUNT) {
+      index = PROBES_BUCKET_COUNT - 1;
+    }
+  }
+
+  // Single writer: readers see either the old or the new count
+  uint64_t *count = &probes->counts[stage][index];
+  __atomic_store_n(count, __atomic_load_n(count, __ATOMIC_RELAXED) + 1,
+                   __ATOMIC_RELAXED);
+  if (ticks > __atomic_load_n(&probes->max[stage], __ATOMIC_RELAXED)) {
+    __atomic_store_n(&probes->max[stage], ticks, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * \brief Creates the histograms and installs the SIGUSR1 handler.
+ *
+ * \return Whether the histograms are created (errno is set otherwise).
+ */
+bool probes_init(void);
+
+/**
+ * \brief Dumps the histograms if SIGUSR1 was received since the last call.
+ */
+void probes_poll(void);
+
+/**
+ * \brief Writes the count and the percentiles of each stage to stderr.
+ */
+void probes_dump(void);
+
+#define PROBE_START(clock) uint64_t clock = probes_now()
+#define PROBE_RESTART(clock) clock = probes_now()
+#define PROBE(clock, stage) probes_record(stage, &clock)
+#define PROBES_INIT() probes_init()
+#define PROBES_POLL() probes_poll()
+#define PROBES_DUMP() probes_dump()
+
+#else
+
+#define PROBE_START(clock)
+#define PROBE_RESTART(clock)
+#define PROBE(clock, stage)
+#define PROBES_INIT() true
+#define PROBES_POLL()
+#define PROBES_DUMP()
+
+#endif // STAGE_PROBES
+
+#endif // PROBES_H
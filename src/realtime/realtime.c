@@ -0,0 +1,151 @@
+/**
+ * \brief This file implements the real-time mode of the application.
+ */
+#define _GNU_SOURCE // sched_setaffinity()
+#include <inttypes.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "realtime.h"
+
+#define REALTIME_JITTER_BUCKETS (REALTIME_PERIOD_US / 2 + 1) // 1us each
+#define REALTIME_CACHE_LINE 64
+
+static bool realtime_entered = false;
+
+// Wakeups, relative to the grid started by the first one
+static uint64_t realtime_first;     // Nanoseconds
+static uint64_t realtime_last_tick; // Point of the grid of the last wakeup
+static uint64_t realtime_wakeups;
+static uint64_t realtime_missed;
+static uint64_t realtime_jitter_sum; // Microseconds
+static uint64_t realtime_jitter_max; // Microseconds
+static uint64_t realtime_jitters[REALTIME_JITTER_BUCKETS];
+
+/**
+ * \brief Touches the pages of stack the loop may use.
+ */
+static __attribute__((noinline)) void realtime_prefault_stack(void) {
+
+  volatile uint8_t stack[REALTIME_STACK_PREFAULT];
+  long page_size = sysconf(_SC_PAGESIZE);
+  for (size_t i = 0; i < sizeof(stack); i += (size_t)page_size) {
+    stack[i] = 0;
+  }
+}
+
+bool realtime_enter(const struct realtime_config_t *config,
+                    const struct realtime_region_t *regions,
+                    size_t region_count) {
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(config->cpu, &cpus);
+  if (sched_setaffinity(0, sizeof(cpus), &cpus) == -1) {
+    return false;
+  }
+
+  struct sched_param parameters = {.sched_priority = config->priority};
+  if (sched_setscheduler(0, SCHED_FIFO, &parameters) == -1) {
+    return false;
+  }
+
+  // The current pages are faulted in, the future ones as soon as mapped
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+    return false;
+  }
+  realtime_prefault_stack();
+  for (size_t i = 0; i < region_count; i++) {
+    const volatile uint8_t *bytes = regions[i].address;
+    for (size_t j = 0; j < regions[i].size; j += REALTIME_CACHE_LINE) {
+      (void)bytes[j];
+    }
+  }
+
+  realtime_wakeups = 0;
+  realtime_missed = 0;
+  realtime_jitter_sum = 0;
+  realtime_jitter_max = 0;
+  memset(realtime_jitters, 0, sizeof(realtime_jitters));
+  realtime_entered = true;
+  return true;
+}
+
+void realtime_wakeup(void) {
+
+  if (!realtime_entered) {
+    return;
+  }
+  struct timespec now_spec;
+  clock_gettime(CLOCK_MONOTONIC, &now_spec);
+  uint64_t now =
+      (uint64_t)now_spec.tv_sec * 1000000000u + (uint64_t)now_spec.tv_nsec;
+
+  if (realtime_wakeups++ == 0) {
+    realtime_first = now;
+    realtime_last_tick = 0;
+    realtime_jitters[0]++;
+    return;
+  }
+
+  // Nearest point of the grid
+  const uint64_t period = REALTIME_PERIOD_US * 1000u;
+  uint64_t elapsed = now - realtime_first;
+  uint64_t tick = (elapsed + period / 2) / period;
+  uint64_t expected = tick * period;
+  uint64_t jitter =
+      (elapsed > expected ? elapsed - expected : expected - elapsed) / 1000;
+
+  if (tick > realtime_last_tick + 1) {
+    realtime_missed += tick - realtime_last_tick - 1;
+  }
+  realtime_last_tick = tick;
+  realtime_jitter_sum += jitter;
+  if (jitter > realtime_jitter_max) {
+    realtime_jitter_max = jitter;
+  }
+  realtime_jitters[jitter < REALTIME_JITTER_BUCKETS
+                       ? jitter
+                       : REALTIME_JITTER_BUCKETS - 1]++;
+}
+
+/**
+ * \brief Returns a percentile of the jitters.
+ *
+ * \param[in] quantile Quantile, between 0 and 1.
+ * \return Jitter, in microseconds.
+ */
+static uint64_t realtime_percentile(double quantile) {
+
+  uint64_t rank = (uint64_t)(quantile * (double)realtime_wakeups);
+  uint64_t cumulated = 0;
+  for (uint64_t i = 0; i < REALTIME_JITTER_BUCKETS; i++) {
+    cumulated += realtime_jitters[i];
+    if (cumulated > rank) {
+      return i;
+    }
+  }
+  return REALTIME_JITTER_BUCKETS - 1;
+}
+
+void realtime_report(void) {
+
+  if (!realtime_entered || realtime_wakeups == 0) {
+    return;
+  }
+  if (fprintf(stderr,
+              "[INFO] Real-time: %" PRIu64 " wakeups, %" PRIu64
+              " missed deadlines, jitter mean %.1f us, p50 %" PRIu64
+              " us, p99 %" PRIu64 " us, p99.9 %" PRIu64 " us, max %" PRIu64
+              " us\n",
+              realtime_wakeups, realtime_missed,
+              (double)realtime_jitter_sum / (double)realtime_wakeups,
+              realtime_percentile(0.5), realtime_percentile(0.99),
+              realtime_percentile(0.999), realtime_jitter_max) < 0) {
+    perror("[WARN] Failed to write to stderr");
+  }
+}
@@ -0,0 +1,64 @@
+/**
+ * \brief This file defines the real-time mode of the application: CPU pinning,
+ * SCHED_FIFO scheduling, locked and prefaulted memory, and the measure of the
+ * jitter of the 10ms wakeups.
+ *
+ * The jitter of a wakeup is its distance to the 10ms grid started by the first
+ * wakeup. A wakeup more than half a period away from the next point of the
+ * grid is counted against the following point, and the points of the grid
+ * without a wakeup are missed deadlines.
+ */
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define REALTIME_PERIOD_US 10000        // UDP 10ms frames
+#define REALTIME_STACK_PREFAULT 262144 // Bytes of stack touched in advance
+
+/**
+ * \brief Settings of the real-time mode.
+ */
+struct realtime_config_t {
+  int cpu;      // CPU the process is pinned to
+  int priority; // SCHED_FIFO priority, from 1 to 99
+};
+
+/**
+ * \brief Memory region touched in advance, so that its first access in the
+ * loop doesn't fault or miss the cache.
+ */
+struct realtime_region_t {
+  void *address;
+  size_t size;
+};
+
+/**
+ * \brief Enters the real-time mode: pins the process to its CPU, switches it
+ * to SCHED_FIFO, locks its current and future memory, and touches its stack
+ * and the given regions. The threads created afterwards inherit the
+ * scheduling policy and the CPU.
+ *
+ * \param[in] config Settings.
+ * \param[in] regions Regions to touch.
+ * \param[in] region_count Number of regions.
+ * \return Whether the real-time mode is entered (errno is set otherwise).
+ */
+bool realtime_enter(const struct realtime_config_t *config,
+                    const struct realtime_region_t *regions,
+                    size_t region_count);
+
+/**
+ * \brief Records a 10ms wakeup, if the real-time mode is entered.
+ */
+void realtime_wakeup(void);
+
+/**
+ * \brief Writes the jitter of the wakeups and the missed deadlines to stderr,
+ * if the real-time mode is entered.
+ */
+void realtime_report(void);
+
+#endif // REALTIME_H
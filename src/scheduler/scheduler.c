@@ -0,0 +1,59 @@
+/**
+ * \brief This file implements the periodic tasks of the application.
+ */
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "scheduler.h"
+
+uint64_t scheduler_now(void) {
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+void scheduler_task_init(struct scheduler_task_t *task, const char *name,
+                         uint64_t period, uint64_t start) {
+
+  task->name = name;
+  task->period = period;
+  task->deadline = start;
+  task->runs = 0;
+  task->overruns = 0;
+  task->max_lateness = 0;
+}
+
+bool scheduler_task_due(struct scheduler_task_t *task, uint64_t now) {
+
+  if (now < task->deadline) {
+    return false;
+  }
+
+  uint64_t lateness = now - task->deadline;
+  uint64_t missed = lateness / task->period;
+  if (lateness > task->max_lateness) {
+    task->max_lateness = lateness;
+  }
+  task->runs++;
+  task->overruns += missed;
+  // From the deadline rather than from now, so that the task doesn't drift
+  task->deadline += (missed + 1) * task->period;
+  return true;
+}
+
+void scheduler_report(const struct scheduler_task_t *tasks, size_t task_count) {
+
+  for (size_t i = 0; i < task_count; i++) {
+    if (fprintf(stderr,
+                "[INFO] Task %s (%.1f ms): %" PRIu64 " runs, %" PRIu64
+                " overruns, %.3f ms max lateness\n",
+                tasks[i].name, (double)tasks[i].period / SCHEDULER_NS_PER_MS,
+                tasks[i].runs, tasks[i].overruns,
+                (double)tasks[i].max_lateness / SCHEDULER_NS_PER_MS) < 0) {
+      perror("[WARN] Failed to write to stderr");
+    }
+  }
+}
@@ -0,0 +1,67 @@
+/**
+ * \brief This file defines the periodic tasks of the application, scheduled
+ * from the monotonic clock.
+ *
+ * The deadlines of a task are absolute: each one is the previous one plus the
+ * period, so that the task doesn't drift whatever its lateness. A task that
+ * runs after the deadline of its next period has overrun: the periods missed
+ * are counted, and the deadlines resume from the current period.
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCHEDULER_NS_PER_MS 1000000
+
+/**
+ * \brief Periodic task.
+ */
+struct scheduler_task_t {
+  const char *name;
+  uint64_t period;   // Nanoseconds
+  uint64_t deadline; // Next deadline, monotonic clock in nanoseconds
+  uint64_t runs;
+  uint64_t overruns;     // Periods missed
+  uint64_t max_lateness; // Nanoseconds after the deadline
+};
+
+/**
+ * \brief Returns the monotonic clock.
+ *
+ * \return CLOCK_MONOTONIC, in nanoseconds.
+ */
+uint64_t scheduler_now(void);
+
+/**
+ * \brief Initializes a task.
+ *
+ * \param[out] task Task.
+ * \param[in] name Name of the task, for the report.
+ * \param[in] period Period, in nanoseconds.
+ * \param[in] start Start of the first period: the task is due at once.
+ */
+void scheduler_task_init(struct scheduler_task_t *task, const char *name,
+                         uint64_t period, uint64_t start);
+
+/**
+ * \brief Checks whether a task is due, and if so accounts for its run and
+ * moves its deadline to the next period.
+ *
+ * \param[in,out] task Task.
+ * \param[in] now Monotonic clock, in nanoseconds.
+ * \return Whether the task must run.
+ */
+bool scheduler_task_due(struct scheduler_task_t *task, uint64_t now);
+
+/**
+ * \brief Writes the runs, overruns and maximum lateness of tasks to stderr.
+ *
+ * \param[in] tasks Tasks.
+ * \param[in] task_count Number of tasks.
+ */
+void scheduler_report(const struct scheduler_task_t *tasks, size_t task_count);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,171 @@
+/**
+ * \brief This file implements the sequence tracker of the MUX frame ID.
+ */
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "sequence.h"
+
+#define SEQUENCE_WORD_BITS 64
+
+static struct sequence_stats_t *sequence_stats = NULL;
+static uint8_t sequence_last = 0;
+
+// Bit per ID, set when the ID is skipped by a gap and cleared when it is
+// received: tells a late frame (counted lost) from a late duplicate
+static uint64_t sequence_missing[SEQUENCE_ID_MAX / SEQUENCE_WORD_BITS + 1];
+
+/**
+ * \brief Marks an ID as missing or received.
+ *
+ * \param[in] id ID, from 1 to SEQUENCE_ID_MAX.
+ * \param[in] missing Whether the ID is missing.
+ */
+static inline void sequence_mark(uint8_t id, bool missing) {
+
+  uint64_t bit = (uint64_t)1 << (id % SEQUENCE_WORD_BITS);
+  sequence_missing[id / SEQUENCE_WORD_BITS] =
+      (sequence_missing[id / SEQUENCE_WORD_BITS] & ~bit) |
+      (bit & -(uint64_t)missing);
+}
+
+/**
+ * \brief Tells whether an ID is missing.
+ *
+ * \param[in] id ID, from 1 to SEQUENCE_ID_MAX.
+ * \return Whether the ID was skipped by a gap and not received since.
+ */
+static inline bool sequence_is_missing(uint8_t id) {
+
+  return (sequence_missing[id / SEQUENCE_WORD_BITS] >>
+          (id % SEQUENCE_WORD_BITS)) &
+         1;
+}
+
+/**
+ * \brief Increments a counter read by other processes.
+ *
+ * \param[in,out] counter Counter.
+ * \param[in] increment Increment.
+ */
+static inline void sequence_count(uint64_t *counter, uint64_t increment) {
+
+  // Single writer: readers see either the old or the new count
+  __atomic_store_n(counter,
+                   __atomic_load_n(counter, __ATOMIC_RELAXED) + increment,
+                   __ATOMIC_RELAXED);
+}
+
+bool sequence_init(uint8_t last_id) {
+
+  // Shared memory if possible, so that the counters can be read by other
+  // processes, private memory otherwise
+  int fd = shm_open(SEQUENCE_SHM_NAME, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1) {
+    if (ftruncate(fd, sizeof(struct sequence_stats_t)) == 0) {
+      sequence_stats = mmap(NULL, sizeof(struct sequence_stats_t),
+                            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+  }
+  if (fd == -1 || sequence_stats == MAP_FAILED || sequence_stats == NULL) {
+    perror("[WARN] Failed to share MUX sequence counters");
+    sequence_stats = mmap(NULL, sizeof(struct sequence_stats_t),
+                          PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0);
+    if (sequence_stats == MAP_FAILED) {
+      sequence_stats = NULL;
+      return false;
+    }
+  }
+  memset(sequence_stats, 0, sizeof(*sequence_stats));
+  sequence_stats->magic = SEQUENCE_MAGIC;
+  sequence_stats->version = SEQUENCE_VERSION;
+  sequence_stats->id_max = SEQUENCE_ID_MAX;
+  sequence_stats->gap_max = SEQUENCE_GAP_MAX;
+  sequence_last = last_id <= SEQUENCE_ID_MAX ? last_id : 0;
+  memset(sequence_missing, 0, sizeof(sequence_missing));
+  return true;
+}
+
+sequence_class_t sequence_track(uint8_t id) {
+
+  sequence_count(&sequence_stats->frames, 1);
+  if (id == 0 || id > SEQUENCE_ID_MAX) {
+    // Out of the sequence, which it can't be compared with
+    sequence_count(&sequence_stats->invalid, 1);
+    return SEQUENCE_INVALID;
+  }
+  if (sequence_last == 0) {
+    sequence_last = id;
+    return SEQUENCE_FIRST;
+  }
+
+  uint32_t distance =
+      ((uint32_t)id + SEQUENCE_ID_MAX - sequence_last) % SEQUENCE_ID_MAX;
+  if (distance == 0) {
+    sequence_count(&sequence_stats->duplicates, 1);
+    return SEQUENCE_DUPLICATE;
+  }
+  if (distance > SEQUENCE_GAP_MAX + 1) {
+    // Behind the highest ID: late if its gap counted it lost, or a duplicate
+    // of a frame already received
+    if (!sequence_is_missing(id)) {
+      sequence_count(&sequence_stats->duplicates, 1);
+      return SEQUENCE_DUPLICATE;
+    }
+    sequence_mark(id, false);
+    sequence_count(&sequence_stats->reorders, 1);
+    return SEQUENCE_REORDER;
+  }
+
+  if (id < sequence_last) {
+    sequence_count(&sequence_stats->wraps, 1);
+  }
+  for (uint32_t skipped = 1; skipped < distance; skipped++) {
+    sequence_mark((sequence_last + skipped - 1) % SEQUENCE_ID_MAX + 1, true);
+  }
+  sequence_mark(id, false);
+  sequence_last = id;
+  if (distance == 1) {
+    sequence_count(&sequence_stats->in_order, 1);
+    return SEQUENCE_IN_ORDER;
+  }
+  sequence_count(&sequence_stats->gaps, 1);
+  sequence_count(&sequence_stats->lost, distance - 1);
+  sequence_count(&sequence_stats->gap_lengths[distance - 1], 1);
+  return SEQUENCE_GAP;
+}
+
+uint8_t sequence_last_id(void) { return sequence_last; }
+
+void sequence_report(void) {
+
+  if (sequence_stats == NULL || sequence_stats->frames == 0) {
+    return;
+  }
+  const struct sequence_stats_t *stats = sequence_stats;
+  if (fprintf(stderr,
+              "[INFO] MUX sequence: %" PRIu64 " frames, %" PRIu64
+              " in order, %" PRIu64 " gaps (%" PRIu64 " frames lost), %" PRIu64
+              " duplicates, %" PRIu64 " reorders, %" PRIu64 " wraps, %" PRIu64
+              " invalid\n",
+              stats->frames, stats->in_order, stats->gaps, stats->lost,
+              stats->duplicates, stats->reorders, stats->wraps,
+              stats->invalid) < 0) {
+    perror("[WARN] Failed to write to stderr");
+    return;
+  }
+  for (uint32_t length = 1; length <= SEQUENCE_GAP_MAX; length++) {
+    if (stats->gap_lengths[length] != 0 &&
+        fprintf(stderr, "[INFO] Gaps of %2" PRIu32 " frames: %" PRIu64 "\n",
+                length, stats->gap_lengths[length]) < 0) {
+      perror("[WARN] Failed to write to stderr");
+      return;
+    }
+  }
+}
@@ -0,0 +1,94 @@
+/**
+ * \brief This file defines the sequence tracker of the MUX frame ID, which
+ * counts the UDP 10ms frames lost, duplicated or received out of order.
+ *
+ * The ID goes from 1 to SEQUENCE_ID_MAX and wraps. A frame is classified by
+ * its distance to the highest ID received, modulo SEQUENCE_ID_MAX:
+ * - 1: in order (a wrap if the ID went from SEQUENCE_ID_MAX back to 1),
+ * - 0: duplicate,
+ * - from 2 to SEQUENCE_ID_MAX / 2: gap, the frames in between are lost,
+ * - above: behind the highest ID, which is kept. The frame is a reorder if
+ *   its ID was skipped by a gap and not received since, a duplicate
+ *   otherwise.
+ * A late frame was counted as lost when its gap was seen, and is counted as
+ * a reorder at most once, so the frames actually lost are lost - reorders.
+ * An ID outside 1..SEQUENCE_ID_MAX, such as 0, is counted as invalid and
+ * leaves the highest ID unchanged.
+ *
+ * The counters are written by the thread running the cycle only, without
+ * atomic read-modify-write, into the shared memory object SEQUENCE_SHM_NAME
+ * where monitoring processes can read them.
+ */
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SEQUENCE_SHM_NAME "/bcgv_mux_sequence"
+#define SEQUENCE_MAGIC 0x51455342u // "BSEQ" in little endian
+#define SEQUENCE_VERSION 2
+
+#define SEQUENCE_ID_MAX 100
+#define SEQUENCE_GAP_MAX (SEQUENCE_ID_MAX / 2 - 1) // Frames lost in a gap
+
+/**
+ * \brief Classes of a received frame.
+ */
+typedef enum sequence_class_t {
+  SEQUENCE_FIRST = 0, // First frame, nothing to compare with
+  SEQUENCE_IN_ORDER = 1,
+  SEQUENCE_DUPLICATE = 2,
+  SEQUENCE_GAP = 3,
+  SEQUENCE_REORDER = 4,
+  SEQUENCE_INVALID = 5 // ID outside 1..SEQUENCE_ID_MAX
+} sequence_class_t;
+
+/**
+ * \brief Counters of the shared memory object.
+ */
+struct sequence_stats_t {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t id_max;
+  uint32_t gap_max;
+  uint64_t frames;
+  uint64_t in_order;
+  uint64_t duplicates;
+  uint64_t gaps;
+  uint64_t lost; // Frames skipped by the gaps
+  uint64_t reorders;
+  uint64_t wraps;
+  uint64_t invalid; // IDs outside 1..SEQUENCE_ID_MAX
+  uint64_t gap_lengths[SEQUENCE_GAP_MAX + 1]; // Gaps per count of frames lost
+};
+
+/**
+ * \brief Creates the counters.
+ *
+ * \param[in] last_id Highest ID received by a previous run, 0 if none.
+ * \return Whether the counters are created (errno is set otherwise).
+ */
+bool sequence_init(uint8_t last_id);
+
+/**
+ * \brief Classifies a received ID and counts it.
+ *
+ * \param[in] id Received ID, valid from 1 to SEQUENCE_ID_MAX.
+ * \return The class of the frame.
+ */
+sequence_class_t sequence_track(uint8_t id);
+
+/**
+ * \brief Returns the highest ID received.
+ *
+ * \return The ID, 0 if none.
+ */
+uint8_t sequence_last_id(void);
+
+/**
+ * \brief Writes the counters and the gap lengths to stderr.
+ */
+void sequence_report(void);
+
+#endif // SEQUENCE_H
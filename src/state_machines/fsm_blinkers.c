@@ -1,6 +1,7 @@
 #include <stddef.h>
 
 #include "fsm_blinkers.h"
+#include "fsm_common.h"
 
 /**
  * \brief The different states of the blinkers FSM.
@@ -110,9 +111,11 @@ struct __attribute__((aligned(FSM_BLINKERS_TRANSITION_ALIGNMENT))) {
  * \param[in,out]   fsm_blinkers_t          Pointer to the FSM to tick.
  * \param[in]       fsm_blinkers_event_t    The event to tick the FSM with.
  * \param[in,out]   fsm_timer_t             Pointer to the FSM timer.
+ * \param[in]       fsm_timer_t             Cycles elapsed, 0 between two
+ *                                          cycles.
  */
 void fsm_blinkers_tick(fsm_blinkers_t *fsm_p, fsm_blinkers_event_t event_p,
-                       fsm_timer_t *timer_p) {
+                       fsm_timer_t *timer_p, fsm_timer_t elapsed_p) {
 #pragma unroll
   for (size_t i = 0; i < FSM_BLINKERS_TRANSITIONS_COUNT; i++) {
 
@@ -129,27 +132,35 @@ void fsm_blinkers_tick(fsm_blinkers_t *fsm_p, fsm_blinkers_event_t event_p,
     }
   }
 
-  *timer_p += 1;
+  *timer_p += elapsed_p;
 }
 
 #define FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY 100
 #define FSM_BLINKERS_BLINKING_DELAY 100
 
-void compute_left_blinker() {
+/**
+ * \brief Compute the left blinker FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands and
+ *                        acknowledgements between two cycles.
+ */
+static void step_left_blinker(struct application_t *ctx, fsm_timer_t elapsed) {
 
-  fsm_blinkers_t fsm = get_fsm_left_blinker();
+  fsm_blinkers_t fsm = get_fsm_left_blinker_ctx(ctx);
   fsm_blinkers_event_t event;
-  fsm_timer_t timer = get_fsm_left_blinker_timer();
+  fsm_timer_t timer = get_fsm_left_blinker_timer_ctx(ctx);
 
   // Compute event
 
-  if (get_left_blinker_in() || get_warnings_in()) {
+  if (get_left_blinker_in_ctx(ctx) || get_warnings_in_ctx(ctx)) {
 
-    if (get_left_blinker_acknowledgement()) {
+    if (get_left_blinker_acknowledgement_ctx(ctx)) {
       event = FSM_BLINKERS_EVENT_ACK_RECEIVED;
-    } else if (timer > FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY) {
       event = FSM_BLINKERS_EVENT_ACK_MISSED;
-    } else if (timer > FSM_BLINKERS_BLINKING_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_BLINKERS_BLINKING_DELAY) {
       event = FSM_BLINKERS_EVENT_BLINK;
     } else {
       event = FSM_BLINKERS_EVENT_COMMAND_ON;
@@ -161,13 +172,13 @@ void compute_left_blinker() {
 
   // Tick FSM
 
-  fsm_blinkers_tick(&fsm, event, &timer);
+  fsm_blinkers_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_left_blinker(fsm);
-  set_fsm_left_blinker_timer(timer);
-  set_left_blinker_acknowledgement(false);
+  set_fsm_left_blinker_ctx(ctx, fsm);
+  set_fsm_left_blinker_timer_ctx(ctx, timer);
+  set_left_blinker_acknowledgement_ctx(ctx, false);
 
   switch ((fsm_blinkers_state_t)fsm) {
 
@@ -175,31 +186,39 @@ void compute_left_blinker() {
   case FSM_BLINKERS_ERROR:
   case FSM_BLINKERS_ACTIVE_OFF:
   case FSM_BLINKERS_ACTIVE_OFF_ACKNOWLEDGED:
-    set_left_blinker_out(false);
+    set_left_blinker_out_ctx(ctx, false);
     break;
   case FSM_BLINKERS_ACTIVE_ON:
   case FSM_BLINKERS_ACTIVE_ON_ACKNOWLEDGED:
-    set_left_blinker_out(true);
-    set_indicator_warnings(get_warnings_in());
+    set_left_blinker_out_ctx(ctx, true);
+    set_indicator_warnings_ctx(ctx, get_warnings_in_ctx(ctx));
     break;
   }
 }
 
-void compute_right_blinker() {
+/**
+ * \brief Compute the right blinker FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands and
+ *                        acknowledgements between two cycles.
+ */
+static void step_right_blinker(struct application_t *ctx, fsm_timer_t elapsed) {
 
-  fsm_blinkers_t fsm = get_fsm_right_blinker();
+  fsm_blinkers_t fsm = get_fsm_right_blinker_ctx(ctx);
   fsm_blinkers_event_t event;
-  fsm_timer_t timer = get_fsm_right_blinker_timer();
+  fsm_timer_t timer = get_fsm_right_blinker_timer_ctx(ctx);
 
   // Compute event
 
-  if (get_right_blinker_in() || get_warnings_in()) {
+  if (get_right_blinker_in_ctx(ctx) || get_warnings_in_ctx(ctx)) {
 
-    if (get_right_blinker_acknowledgement()) {
+    if (get_right_blinker_acknowledgement_ctx(ctx)) {
       event = FSM_BLINKERS_EVENT_ACK_RECEIVED;
-    } else if (timer > FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY) {
       event = FSM_BLINKERS_EVENT_ACK_MISSED;
-    } else if (timer > FSM_BLINKERS_BLINKING_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_BLINKERS_BLINKING_DELAY) {
       event = FSM_BLINKERS_EVENT_BLINK;
     } else {
       event = FSM_BLINKERS_EVENT_COMMAND_ON;
@@ -211,13 +230,13 @@ void compute_right_blinker() {
 
   // Tick FSM
 
-  fsm_blinkers_tick(&fsm, event, &timer);
+  fsm_blinkers_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_right_blinker(fsm);
-  set_fsm_right_blinker_timer(timer);
-  set_right_blinker_acknowledgement(false);
+  set_fsm_right_blinker_ctx(ctx, fsm);
+  set_fsm_right_blinker_timer_ctx(ctx, timer);
+  set_right_blinker_acknowledgement_ctx(ctx, false);
 
   switch ((fsm_blinkers_state_t)fsm) {
 
@@ -225,12 +244,130 @@ void compute_right_blinker() {
   case FSM_BLINKERS_ERROR:
   case FSM_BLINKERS_ACTIVE_OFF:
   case FSM_BLINKERS_ACTIVE_OFF_ACKNOWLEDGED:
-    set_right_blinker_out(false);
+    set_right_blinker_out_ctx(ctx, false);
     break;
   case FSM_BLINKERS_ACTIVE_ON:
   case FSM_BLINKERS_ACTIVE_ON_ACKNOWLEDGED:
-    set_right_blinker_out(true);
-    set_indicator_warnings(get_warnings_in());
+    set_right_blinker_out_ctx(ctx, true);
+    set_indicator_warnings_ctx(ctx, get_warnings_in_ctx(ctx));
     break;
   }
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Compute a blinker FSM for every vehicle of a fleet in a single pass.
+ *
+ * Each transition of fsm_blinkers_transitions is applied with a select, its
+ * event being expanded, instead of walking the table. As no (state, event) pair
+ * appears twice in the table, at most one transition applies to each vehicle.
+ *
+ * \param[in]       size                Number of vehicles.
+ * \param[in]       in                  Command inputs.
+ * \param[in]       warnings_in         Warnings command inputs.
+ * \param[in,out]   acknowledgement     Acknowledgements of the commands.
+ * \param[in,out]   fsm                 FSM states.
+ * \param[in,out]   timer               FSM timers.
+ * \param[out]      out                 Command outputs.
+ * \param[in,out]   indicator_warnings  Warnings indicators.
+ */
+static void compute_blinker_lanes(size_t size, const uint8_t *restrict in,
+                                  const uint8_t *restrict warnings_in,
+                                  uint8_t *restrict acknowledgement,
+                                  int8_t *restrict fsm,
+                                  fsm_timer_t *restrict timer,
+                                  uint8_t *restrict out,
+                                  uint8_t *restrict indicator_warnings) {
+  in = __builtin_assume_aligned(in, FLEET_ALIGNMENT);
+  warnings_in = __builtin_assume_aligned(warnings_in, FLEET_ALIGNMENT);
+  acknowledgement = __builtin_assume_aligned(acknowledgement, FLEET_ALIGNMENT);
+  fsm = __builtin_assume_aligned(fsm, FLEET_ALIGNMENT);
+  timer = __builtin_assume_aligned(timer, FLEET_ALIGNMENT);
+  out = __builtin_assume_aligned(out, FLEET_ALIGNMENT);
+  indicator_warnings =
+      __builtin_assume_aligned(indicator_warnings, FLEET_ALIGNMENT);
+
+  for (size_t i = 0; i < size; i++) {
+
+    int state = fsm[i];
+    int warnings = warnings_in[i] != 0;
+    int command = (in[i] != 0) | warnings;
+    int acknowledged = acknowledgement[i] != 0;
+    int late = timer[i] > FSM_BLINKERS_ACKNOWLEDGEMENT_DELAY;
+    int blink = timer[i] > FSM_BLINKERS_BLINKING_DELAY;
+
+    // Tick FSM
+
+    int next = state;
+    next = fsm_select( // Command on
+        (state == FSM_BLINKERS_OFF) & command & !acknowledged & !late & !blink,
+        FSM_BLINKERS_ACTIVE_ON, next);
+    next = fsm_select( // Command off, from any active state
+        (state != FSM_BLINKERS_OFF) & (state != FSM_BLINKERS_ERROR) & !command,
+        FSM_BLINKERS_OFF, next);
+    next = fsm_select( // Acknowledgement received
+        (state == FSM_BLINKERS_ACTIVE_ON) & command & acknowledged,
+        FSM_BLINKERS_ACTIVE_ON_ACKNOWLEDGED, next);
+    next = fsm_select( // Acknowledgement received
+        (state == FSM_BLINKERS_ACTIVE_OFF) & command & acknowledged,
+        FSM_BLINKERS_ACTIVE_OFF_ACKNOWLEDGED, next);
+    next = fsm_select( // Acknowledgement missed
+        ((state == FSM_BLINKERS_ACTIVE_ON) |
+         (state == FSM_BLINKERS_ACTIVE_OFF)) &
+            command & !acknowledged & late,
+        FSM_BLINKERS_ERROR, next);
+    next = fsm_select( // Blink
+        (state == FSM_BLINKERS_ACTIVE_ON_ACKNOWLEDGED) & command &
+            !acknowledged & !late & blink,
+        FSM_BLINKERS_ACTIVE_OFF, next);
+    next = fsm_select( // Blink
+        (state == FSM_BLINKERS_ACTIVE_OFF_ACKNOWLEDGED) & command &
+            !acknowledged & !late & blink,
+        FSM_BLINKERS_ACTIVE_ON, next);
+
+    // The error state transitions to itself on any event
+    int fired = (next != state) | (state == FSM_BLINKERS_ERROR);
+
+    // Update data
+
+    int on = (next == FSM_BLINKERS_ACTIVE_ON) |
+             (next == FSM_BLINKERS_ACTIVE_ON_ACKNOWLEDGED);
+
+    fsm[i] = (int8_t)next;
+    timer[i] = (fsm_timer_t)(fsm_select(fired, 0, timer[i]) + 1);
+    acknowledgement[i] = false;
+    out[i] = on;
+    indicator_warnings[i] = fsm_select(on, warnings, indicator_warnings[i]);
+  }
+}
+
+void compute_left_blinker_batch(struct fleet_t *fleet) {
+  compute_blinker_lanes(fleet->size, fleet->left_blinker_in, fleet->warnings_in,
+                        fleet->left_blinker_acknowledgement,
+                        fleet->fsm_left_blinker, fleet->fsm_left_blinker_timer,
+                        fleet->left_blinker_out, fleet->indicator_warnings);
+}
+
+void compute_right_blinker_batch(struct fleet_t *fleet) {
+  compute_blinker_lanes(fleet->size, fleet->right_blinker_in,
+                        fleet->warnings_in,
+                        fleet->right_blinker_acknowledgement,
+                        fleet->fsm_right_blinker,
+                        fleet->fsm_right_blinker_timer,
+                        fleet->right_blinker_out, fleet->indicator_warnings);
+}
+
+void compute_left_blinker_ctx(struct application_t *ctx) {
+  step_left_blinker(ctx, 1);
+}
+
+void compute_right_blinker_ctx(struct application_t *ctx) {
+  step_right_blinker(ctx, 1);
+}
+
+void compute_left_blinker() { compute_left_blinker_ctx(&application); }
+
+void compute_right_blinker() { compute_right_blinker_ctx(&application); }
+
+void react_left_blinker() { step_left_blinker(&application, 0); }
+
+void react_right_blinker() { step_right_blinker(&application, 0); }
@@ -13,10 +13,54 @@
  */
 void compute_left_blinker();
 
+/**
+ * \brief Compute the left blinker FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_left_blinker_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the left blinker FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_left_blinker_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the left blinker FSM its command and acknowledgement events
+ * between two cycles, without advancing its timer.
+ */
+void react_left_blinker();
+
 /**
  * \brief Compute the right blinker FSM with the current application data and
  * update them.
  */
 void compute_right_blinker();
 
+/**
+ * \brief Compute the right blinker FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_right_blinker_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the right blinker FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_right_blinker_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the right blinker FSM its command and acknowledgement events
+ * between two cycles, without advancing its timer.
+ */
+void react_right_blinker();
+
 #endif // FSM_BLINKERS_H
@@ -0,0 +1,19 @@
+/**
+ * \brief This file defines the helpers shared by the finite state machines.
+ */
+#ifndef FSM_COMMON_H
+#define FSM_COMMON_H
+
+/**
+ * \brief Branch-free select, used by the batch functions so that their loop
+ * can be vectorized.
+ *
+ * \param[in]   condition   0 or 1.
+ * \param[in]   value_true  Value returned if condition is 1.
+ * \param[in]   value_false Value returned if condition is 0.
+ */
+static inline int fsm_select(int condition, int value_true, int value_false) {
+  return value_false ^ ((value_false ^ value_true) & -condition);
+}
+
+#endif // FSM_COMMON_H
@@ -1,6 +1,7 @@
 #include <stddef.h>
 
 #include "fsm_lights.h"
+#include "fsm_common.h"
 
 /**
  * \brief The different states of the lights FSM.
@@ -77,9 +78,10 @@ struct __attribute__((aligned(FSM_LIGHTS_TRANSITION_ALIGNMENT))) {
  * \param[in,out]   fsm_lights_t        Pointer to the FSM to tick.
  * \param[in]       fsm_lights_event_t  The event to tick the FSM with.
  * \param[in,out]   fsm_timer_t         Pointer to the FSM timer.
+ * \param[in]       fsm_timer_t         Cycles elapsed, 0 between two cycles.
  */
 static void fsm_lights_tick(fsm_lights_t *fsm_p, fsm_lights_event_t event_p,
-                            fsm_timer_t *timer_p) {
+                            fsm_timer_t *timer_p, fsm_timer_t elapsed_p) {
 #pragma unroll
   for (size_t i = 0; i < FSM_LIGHTS_TRANSITIONS_COUNT; i++) {
 
@@ -96,24 +98,32 @@ static void fsm_lights_tick(fsm_lights_t *fsm_p, fsm_lights_event_t event_p,
     }
   }
 
-  *timer_p += 1;
+  *timer_p += elapsed_p;
 }
 
 #define FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY 100
 
-void compute_headlights() {
+/**
+ * \brief Compute the headlights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands and
+ *                        acknowledgements between two cycles.
+ */
+static void step_headlights(struct application_t *ctx, fsm_timer_t elapsed) {
 
   // Compute event
 
-  fsm_lights_t fsm = get_fsm_headlights();
+  fsm_lights_t fsm = get_fsm_headlights_ctx(ctx);
   fsm_lights_event_t event;
-  fsm_timer_t timer = get_fsm_headlights_timer();
+  fsm_timer_t timer = get_fsm_headlights_timer_ctx(ctx);
 
-  if (get_headlights_in()) {
+  if (get_headlights_in_ctx(ctx)) {
 
-    if (get_headlights_acknowledgement()) {
+    if (get_headlights_acknowledgement_ctx(ctx)) {
       event = FSM_LIGHTS_EVENT_ACK_RECEIVED;
-    } else if (timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
       event = FSM_LIGHTS_EVENT_ACK_MISSED;
     } else {
       event = FSM_LIGHTS_EVENT_COMMAND_ON;
@@ -125,47 +135,55 @@ void compute_headlights() {
 
   // Tick FSM
 
-  fsm_lights_tick(&fsm, event, &timer);
+  fsm_lights_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_headlights(fsm);
-  set_fsm_headlights_timer(timer);
-  set_headlights_acknowledgement(false);
+  set_fsm_headlights_ctx(ctx, fsm);
+  set_fsm_headlights_timer_ctx(ctx, timer);
+  set_headlights_acknowledgement_ctx(ctx, false);
 
   switch ((fsm_lights_state_t)fsm) {
 
   case FSM_LIGHTS_OFF:
   case FSM_LIGHTS_ERROR:
-    set_headlights_out(false);
-    set_indicator_headlights(false);
+    set_headlights_out_ctx(ctx, false);
+    set_indicator_headlights_ctx(ctx, false);
     break;
 
   case FSM_LIGHTS_ON:
-    set_headlights_out(true);
-    set_indicator_headlights(false);
+    set_headlights_out_ctx(ctx, true);
+    set_indicator_headlights_ctx(ctx, false);
     break;
 
   case FSM_LIGHTS_ACKNOWLEDGED:
-    set_headlights_out(true);
-    set_indicator_headlights(true);
+    set_headlights_out_ctx(ctx, true);
+    set_indicator_headlights_ctx(ctx, true);
     break;
   }
 }
 
-void compute_sidelights() {
+/**
+ * \brief Compute the sidelights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands and
+ *                        acknowledgements between two cycles.
+ */
+static void step_sidelights(struct application_t *ctx, fsm_timer_t elapsed) {
 
-  fsm_lights_t fsm = get_fsm_sidelights();
+  fsm_lights_t fsm = get_fsm_sidelights_ctx(ctx);
   fsm_lights_event_t event;
-  fsm_timer_t timer = get_fsm_sidelights_timer();
+  fsm_timer_t timer = get_fsm_sidelights_timer_ctx(ctx);
 
   // Compute event
 
-  if (get_sidelights_in()) {
+  if (get_sidelights_in_ctx(ctx)) {
 
-    if (get_sidelights_acknowledgement()) {
+    if (get_sidelights_acknowledgement_ctx(ctx)) {
       event = FSM_LIGHTS_EVENT_ACK_RECEIVED;
-    } else if (timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
       event = FSM_LIGHTS_EVENT_ACK_MISSED;
     } else {
       event = FSM_LIGHTS_EVENT_COMMAND_ON;
@@ -177,47 +195,55 @@ void compute_sidelights() {
 
   // Tick FSM
 
-  fsm_lights_tick(&fsm, event, &timer);
+  fsm_lights_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_sidelights(fsm);
-  set_fsm_sidelights_timer(fsm);
-  set_sidelights_acknowledgement(false);
+  set_fsm_sidelights_ctx(ctx, fsm);
+  set_fsm_sidelights_timer_ctx(ctx, timer);
+  set_sidelights_acknowledgement_ctx(ctx, false);
 
   switch ((fsm_lights_state_t)fsm) {
 
   case FSM_LIGHTS_OFF:
   case FSM_LIGHTS_ERROR:
-    set_sidelights_out(false);
-    set_indicator_sidelights(false);
+    set_sidelights_out_ctx(ctx, false);
+    set_indicator_sidelights_ctx(ctx, false);
     break;
 
   case FSM_LIGHTS_ON:
-    set_sidelights_out(true);
-    set_indicator_sidelights(false);
+    set_sidelights_out_ctx(ctx, true);
+    set_indicator_sidelights_ctx(ctx, false);
     break;
 
   case FSM_LIGHTS_ACKNOWLEDGED:
-    set_sidelights_out(true);
-    set_indicator_sidelights(true);
+    set_sidelights_out_ctx(ctx, true);
+    set_indicator_sidelights_ctx(ctx, true);
     break;
   }
 }
 
-void compute_redlights() {
+/**
+ * \brief Compute the redlights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands and
+ *                        acknowledgements between two cycles.
+ */
+static void step_redlights(struct application_t *ctx, fsm_timer_t elapsed) {
 
-  fsm_lights_t fsm = get_fsm_redlights();
+  fsm_lights_t fsm = get_fsm_redlights_ctx(ctx);
   fsm_lights_event_t event;
-  fsm_timer_t timer = get_fsm_redlights_timer();
+  fsm_timer_t timer = get_fsm_redlights_timer_ctx(ctx);
 
   // Compute event
 
-  if (get_redlights_in()) {
+  if (get_redlights_in_ctx(ctx)) {
 
-    if (get_redlights_acknowledgement()) {
+    if (get_redlights_acknowledgement_ctx(ctx)) {
       event = FSM_LIGHTS_EVENT_ACK_RECEIVED;
-    } else if (timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
+    } else if (elapsed != 0 && timer > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY) {
       event = FSM_LIGHTS_EVENT_ACK_MISSED;
     } else {
       event = FSM_LIGHTS_EVENT_COMMAND_ON;
@@ -229,28 +255,138 @@ void compute_redlights() {
 
   // Tick FSM
 
-  fsm_lights_tick(&fsm, event, &timer);
+  fsm_lights_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_redlights(fsm);
-  set_fsm_redlights_timer(timer);
-  set_redlights_acknowledgement(false);
+  set_fsm_redlights_ctx(ctx, fsm);
+  set_fsm_redlights_timer_ctx(ctx, timer);
+  set_redlights_acknowledgement_ctx(ctx, false);
 
   switch ((fsm_lights_state_t)fsm) {
 
   case FSM_LIGHTS_OFF:
   case FSM_LIGHTS_ERROR:
-    set_redlights_out(false);
-    set_indicator_redlights(false);
+    set_redlights_out_ctx(ctx, false);
+    set_indicator_redlights_ctx(ctx, false);
     break;
   case FSM_LIGHTS_ON:
-    set_redlights_out(true);
-    set_indicator_redlights(false);
+    set_redlights_out_ctx(ctx, true);
+    set_indicator_redlights_ctx(ctx, false);
     break;
   case FSM_LIGHTS_ACKNOWLEDGED:
-    set_redlights_out(true);
-    set_indicator_redlights(true);
+    set_redlights_out_ctx(ctx, true);
+    set_indicator_redlights_ctx(ctx, true);
     break;
   }
 }
+
+/**
+ * \brief Compute a lights FSM for every vehicle of a fleet in a single pass.
+ *
+ * Each transition of fsm_lights_transitions is applied with a select, its event
+ * being expanded, instead of walking the table. As no (state, event) pair
+ * appears twice in the table, at most one transition applies to each vehicle.
+ *
+ * \param[in]       size            Number of vehicles.
+ * \param[in]       in              Command inputs.
+ * \param[in,out]   acknowledgement Acknowledgements of the command messages.
+ * \param[in,out]   fsm             FSM states.
+ * \param[in,out]   timer           FSM timers.
+ * \param[out]      out             Command outputs.
+ * \param[out]      indicator       Indicators.
+ */
+static void compute_lights_lanes(size_t size, const uint8_t *restrict in,
+                                 uint8_t *restrict acknowledgement,
+                                 int8_t *restrict fsm,
+                                 fsm_timer_t *restrict timer,
+                                 uint8_t *restrict out,
+                                 uint8_t *restrict indicator) {
+  in = __builtin_assume_aligned(in, FLEET_ALIGNMENT);
+  acknowledgement = __builtin_assume_aligned(acknowledgement, FLEET_ALIGNMENT);
+  fsm = __builtin_assume_aligned(fsm, FLEET_ALIGNMENT);
+  timer = __builtin_assume_aligned(timer, FLEET_ALIGNMENT);
+  out = __builtin_assume_aligned(out, FLEET_ALIGNMENT);
+  indicator = __builtin_assume_aligned(indicator, FLEET_ALIGNMENT);
+
+  for (size_t i = 0; i < size; i++) {
+
+    int state = fsm[i];
+    int command = in[i] != 0;
+    int acknowledged = acknowledgement[i] != 0;
+    int late = timer[i] > FSM_LIGHTS_ACKNOWLEDGEMENT_DELAY;
+
+    // Tick FSM
+
+    int next = state;
+    next = fsm_select( // Command on
+        (state == FSM_LIGHTS_OFF) & command & !acknowledged & !late,
+        FSM_LIGHTS_ON, next);
+    next = fsm_select( // Command off
+        (state == FSM_LIGHTS_ON) & !command, FSM_LIGHTS_OFF, next);
+    next = fsm_select( // Acknowledgement received
+        (state == FSM_LIGHTS_ON) & command & acknowledged,
+        FSM_LIGHTS_ACKNOWLEDGED, next);
+    next = fsm_select( // Acknowledgement missed
+        (state == FSM_LIGHTS_ON) & command & !acknowledged & late,
+        FSM_LIGHTS_ERROR, next);
+    next = fsm_select( // Command off
+        (state == FSM_LIGHTS_ACKNOWLEDGED) & !command, FSM_LIGHTS_OFF, next);
+
+    // The error state transitions to itself on any event
+    int fired = (next != state) | (state == FSM_LIGHTS_ERROR);
+
+    // Update data
+
+    fsm[i] = (int8_t)next;
+    timer[i] = (fsm_timer_t)(fsm_select(fired, 0, timer[i]) + 1);
+    acknowledgement[i] = false;
+    out[i] = (next == FSM_LIGHTS_ON) | (next == FSM_LIGHTS_ACKNOWLEDGED);
+    indicator[i] = next == FSM_LIGHTS_ACKNOWLEDGED;
+  }
+}
+
+void compute_headlights_batch(struct fleet_t *fleet) {
+  compute_lights_lanes(fleet->size, fleet->headlights_in,
+                       fleet->headlights_acknowledgement, fleet->fsm_headlights,
+                       fleet->fsm_headlights_timer, fleet->headlights_out,
+                       fleet->indicator_headlights);
+}
+
+void compute_sidelights_batch(struct fleet_t *fleet) {
+  compute_lights_lanes(fleet->size, fleet->sidelights_in,
+                       fleet->sidelights_acknowledgement, fleet->fsm_sidelights,
+                       fleet->fsm_sidelights_timer, fleet->sidelights_out,
+                       fleet->indicator_sidelights);
+}
+
+void compute_redlights_batch(struct fleet_t *fleet) {
+  compute_lights_lanes(fleet->size, fleet->redlights_in,
+                       fleet->redlights_acknowledgement, fleet->fsm_redlights,
+                       fleet->fsm_redlights_timer, fleet->redlights_out,
+                       fleet->indicator_redlights);
+}
+
+void compute_headlights_ctx(struct application_t *ctx) {
+  step_headlights(ctx, 1);
+}
+
+void compute_sidelights_ctx(struct application_t *ctx) {
+  step_sidelights(ctx, 1);
+}
+
+void compute_redlights_ctx(struct application_t *ctx) {
+  step_redlights(ctx, 1);
+}
+
+void compute_headlights() { compute_headlights_ctx(&application); }
+
+void compute_sidelights() { compute_sidelights_ctx(&application); }
+
+void compute_redlights() { compute_redlights_ctx(&application); }
+
+void react_headlights() { step_headlights(&application, 0); }
+
+void react_sidelights() { step_sidelights(&application, 0); }
+
+void react_redlights() { step_redlights(&application, 0); }
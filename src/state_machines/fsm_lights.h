@@ -13,16 +13,82 @@
  */
 void compute_headlights();
 
+/**
+ * \brief Compute the headlights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_headlights_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the headlights FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_headlights_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the headlights FSM its command and acknowledgement events
+ * between two cycles, without advancing its timer.
+ */
+void react_headlights();
+
 /**
  * \brief Compute the sidelights FSM with the current application data and
  * update them.
  */
 void compute_sidelights();
 
+/**
+ * \brief Compute the sidelights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_sidelights_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the sidelights FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_sidelights_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the sidelights FSM its command and acknowledgement events
+ * between two cycles, without advancing its timer.
+ */
+void react_sidelights();
+
 /**
  * \brief Compute the redlights FSM with the current application data and
  * update them.
  */
 void compute_redlights();
 
+/**
+ * \brief Compute the redlights FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_redlights_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the redlights FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_redlights_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the redlights FSM its command and acknowledgement events
+ * between two cycles, without advancing its timer.
+ */
+void react_redlights();
+
 #endif // FSM_LIGHTS_H
@@ -1,6 +1,7 @@
 #include <stddef.h>
 
 #include "fsm_wipers.h"
+#include "fsm_common.h"
 
 /**
  * \brief The different states of the wipers FSM.
@@ -87,9 +88,11 @@ struct __attribute__((aligned(FSM_WIPERS_TRANSITION_ALIGNMENT))) {
  * \param[in,out]   fsm_wipers_t          Pointer to the FSM to tick.
  * \param[in]       fsm_wipers_event_t    The event to tick the FSM with.
  * \param[in,out]   fsm_timer_t             Pointer to the FSM timer.
+ * \param[in]       fsm_timer_t             Cycles elapsed, 0 between two
+ *                                          cycles.
  */
 void fsm_wipers_tick(fsm_wipers_t *fsm_p, fsm_wipers_event_t event_p,
-                     fsm_timer_t *timer_p) {
+                     fsm_timer_t *timer_p, fsm_timer_t elapsed_p) {
 #pragma unroll
   for (size_t i = 0; i < FSM_WIPERS_TRANSITIONS_COUNT; i++) {
 
@@ -106,24 +109,33 @@ void fsm_wipers_tick(fsm_wipers_t *fsm_p, fsm_wipers_event_t event_p,
     }
   }
 
-  *timer_p += 1;
+  *timer_p += elapsed_p;
 }
 
 #define FSM_WIPERS_WAITING_DELAY 200
 
-void compute_wipers() {
+/**
+ * \brief Compute the wipers FSM with the application data of an instance and
+ * update them.
+ *
+ * \param[in,out] ctx     Application data of the instance.
+ * \param[in]     elapsed Cycles elapsed, 0 to only react to the commands
+ *                        between two cycles.
+ */
+static void step_wipers(struct application_t *ctx, fsm_timer_t elapsed) {
 
-  fsm_wipers_t fsm = get_fsm_wipers();
+  fsm_wipers_t fsm = get_fsm_wipers_ctx(ctx);
   fsm_wipers_event_t event;
-  fsm_timer_t timer = get_fsm_wipers_timer();
+  fsm_timer_t timer = get_fsm_wipers_timer_ctx(ctx);
 
   // Compute event
 
-  if (fsm == FSM_WIPERS_WAIT && timer > FSM_WIPERS_WAITING_DELAY) {
+  if (elapsed != 0 && fsm == FSM_WIPERS_WAIT &&
+      timer > FSM_WIPERS_WAITING_DELAY) {
     event = FSM_WIPERS_EVENT_TIMEOUT;
-  } else if (get_washer_fluid_in()) {
+  } else if (get_washer_fluid_in_ctx(ctx)) {
     event = FSM_WIPERS_EVENT_COMMAND_WASH;
-  } else if (get_wipers_in()) {
+  } else if (get_wipers_in_ctx(ctx)) {
     event = FSM_WIPERS_EVENT_COMMAND_WIPE;
   } else {
     event = FSM_WIPERS_EVENT_COMMAND_OFF;
@@ -131,27 +143,101 @@ void compute_wipers() {
 
   // Tick FSM
 
-  fsm_wipers_tick(&fsm, event, &timer);
+  fsm_wipers_tick(&fsm, event, &timer, elapsed);
 
   // Update data
 
-  set_fsm_wipers(fsm);
-  set_fsm_wipers_timer(timer);
+  set_fsm_wipers_ctx(ctx, fsm);
+  set_fsm_wipers_timer_ctx(ctx, timer);
 
   switch ((fsm_wipers_state_t)fsm) {
 
   case FSM_WIPERS_OFF:
   case FSM_WIPERS_WAIT:
-    set_wipers_out(false);
-    set_washer_fluid_out(false);
+    set_wipers_out_ctx(ctx, false);
+    set_washer_fluid_out_ctx(ctx, false);
     break;
   case FSM_WIPERS_ON:
-    set_wipers_out(true);
-    set_washer_fluid_out(false);
+    set_wipers_out_ctx(ctx, true);
+    set_washer_fluid_out_ctx(ctx, false);
     break;
   case FSM_WIPERS_WASH:
-    set_wipers_out(true);
-    set_washer_fluid_out(true);
+    set_wipers_out_ctx(ctx, true);
+    set_washer_fluid_out_ctx(ctx, true);
     break;
   }
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Compute the wipers FSM for every vehicle of a fleet in a single pass.
+ *
+ * Each transition of fsm_wipers_transitions is applied with a select, its event
+ * being expanded, instead of walking the table. As no (state, event) pair
+ * appears twice in the table, at most one transition applies to each vehicle.
+ *
+ * \param[in]       size                Number of vehicles.
+ * \param[in]       wipers_in           Wipers command inputs.
+ * \param[in]       washer_fluid_in     Washer fluid command inputs.
+ * \param[in,out]   fsm                 FSM states.
+ * \param[in,out]   timer               FSM timers.
+ * \param[out]      wipers_out          Wipers command outputs.
+ * \param[out]      washer_fluid_out    Washer fluid command outputs.
+ */
+static void compute_wipers_lanes(size_t size, const uint8_t *restrict wipers_in,
+                                 const uint8_t *restrict washer_fluid_in,
+                                 int8_t *restrict fsm,
+                                 fsm_timer_t *restrict timer,
+                                 uint8_t *restrict wipers_out,
+                                 uint8_t *restrict washer_fluid_out) {
+  wipers_in = __builtin_assume_aligned(wipers_in, FLEET_ALIGNMENT);
+  washer_fluid_in = __builtin_assume_aligned(washer_fluid_in, FLEET_ALIGNMENT);
+  fsm = __builtin_assume_aligned(fsm, FLEET_ALIGNMENT);
+  timer = __builtin_assume_aligned(timer, FLEET_ALIGNMENT);
+  wipers_out = __builtin_assume_aligned(wipers_out, FLEET_ALIGNMENT);
+  washer_fluid_out =
+      __builtin_assume_aligned(washer_fluid_out, FLEET_ALIGNMENT);
+
+  for (size_t i = 0; i < size; i++) {
+
+    int state = fsm[i];
+    int wash = washer_fluid_in[i] != 0;
+    int wipe = wipers_in[i] != 0;
+    int timeout = timer[i] > FSM_WIPERS_WAITING_DELAY;
+
+    // Tick FSM, the timeout event only exists in the waiting state
+
+    int next = state;
+    next = fsm_select( // Command wipe
+        (state == FSM_WIPERS_OFF) & !wash & wipe, FSM_WIPERS_ON, next);
+    next = fsm_select( // Command wash
+        ((state == FSM_WIPERS_OFF) | (state == FSM_WIPERS_ON)) & wash,
+        FSM_WIPERS_WASH, next);
+    next = fsm_select( // Command off
+        (state == FSM_WIPERS_ON) & !wash & !wipe, FSM_WIPERS_OFF, next);
+    next = fsm_select( // Command off or command wipe
+        (state == FSM_WIPERS_WASH) & !wash, FSM_WIPERS_WAIT, next);
+    next = fsm_select( // Timeout
+        (state == FSM_WIPERS_WAIT) & timeout, FSM_WIPERS_OFF, next);
+    next = fsm_select( // Command wash
+        (state == FSM_WIPERS_WAIT) & !timeout & wash, FSM_WIPERS_WASH, next);
+
+    // Update data
+
+    fsm[i] = (int8_t)next;
+    timer[i] = (fsm_timer_t)(fsm_select(next != state, 0, timer[i]) + 1);
+    wipers_out[i] = (next == FSM_WIPERS_ON) | (next == FSM_WIPERS_WASH);
+    washer_fluid_out[i] = next == FSM_WIPERS_WASH;
+  }
+}
+
+void compute_wipers_batch(struct fleet_t *fleet) {
+  compute_wipers_lanes(fleet->size, fleet->wipers_in, fleet->washer_fluid_in,
+                       fleet->fsm_wipers, fleet->fsm_wipers_timer,
+                       fleet->wipers_out, fleet->washer_fluid_out);
+}
+
+void compute_wipers_ctx(struct application_t *ctx) { step_wipers(ctx, 1); }
+
+void compute_wipers() { compute_wipers_ctx(&application); }
+
+void react_wipers() { step_wipers(&application, 0); }
@@ -12,4 +12,26 @@
  */
 __attribute__((unused)) void compute_wipers();
 
+/**
+ * \brief Compute the wipers FSM with the application data of an instance
+ * and update them.
+ *
+ * \param[in,out] ctx Application data of the instance.
+ */
+void compute_wipers_ctx(struct application_t *ctx);
+
+/**
+ * \brief Compute the wipers FSM of every vehicle of a fleet and update
+ * their application data.
+ *
+ * \param[in,out] fleet Fleet store.
+ */
+void compute_wipers_batch(struct fleet_t *fleet);
+
+/**
+ * \brief Feed the wipers FSM its command events between two cycles, without
+ * advancing its timer.
+ */
+void react_wipers();
+
 #endif // FSM_WIPERS_H